@@ -1,10 +1,57 @@
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
+#include <signal.h>
 #include <locale.h>
 #include <pthread.h>
 #include "sim.h"
 #include "langton.h"
+#include "trail.h"
+#include "walk.h"
+#include "watch.h"
 #include "vis.h"
+#include "server.h"
+#include "proto.h"
+#include "metrics.h"
+#include "governor.h"
+
+static volatile sig_atomic_t serving = 1;
+static int with_trail = 0;
+static int with_walk = 0;
+static int with_watch = 0;
+static uint64_t seed = 0;
+static Metrics *metrics = NULL;
+static double target_rate = -1;  // Steps per second, 0 unbounded, -1 per-mode default
+
+// Run one frame's worth of steps as decided by the governor
+static void run_frame(State *st, Governor *g) {
+    int back = take_rewind(g);
+    if (back) {
+        if (rewind_state(st, back)) __atomic_store_n(&g->rewind_failed, 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    int n = begin_frame(g);
+    for (int i = 0; i < n; i++) {
+        advance_state(st);
+        metrics_observe(metrics, st);
+    }
+    end_frame(g, n);
+}
+
+// Langton's ant unless --walk or --watch was given, plus any optional layers
+static int register_rules(State *st) {
+    st->seed = seed;
+    int err = with_watch ? register_watchers(st) :
+              with_walk ? register_random_walk(st) : register_langton(st);
+    if (err) return -1;
+    if (with_trail && register_trail(st, 0.02f, 0.2f)) return -1;
+    return 0;
+}
+
+static void stop_serving(int sig) {
+    serving = 0;
+}
 
 int main_text() {
     Coordinate board_size = {8000, 8000};
@@ -29,28 +76,97 @@ int main_vis() {
     Position starts[2] = { {{3950, 3950}, DOWN}, {{4050, 4050}, UP} };
 
     State st = new_state(board_size, starts, 2);
-    if (register_langton(&st)) exit(EXIT_FAILURE);
+    if (register_rules(&st)) exit(EXIT_FAILURE);
     Renderer *r = create_renderer(board_size.x, board_size.y);
     if (!r) {
         perror("Create renderer");
         exit(EXIT_FAILURE);
     }
 
+    Governor g;
+    init_governor(&g, target_rate >= 0 ? target_rate : 1000);
+    r->governor = &g;
     update_state(r, &st);
 
     pthread_t renderer;
     pthread_create(&renderer, NULL, start_render_thread, r);
 
+    // One published state per frame, however many steps it took
     while (!r->should_exit) {
-        usleep(500);
-        advance_state(&st);
+        run_frame(&st, &g);
         update_state(r, &st);
     }
 
     return 0;
 }
 
-int main() {
-    main_vis();
+int main_serve(const char *path) {
+    Coordinate board_size = {8000, 8000};
+    Position starts[2] = { {{3950, 3950}, DOWN}, {{4050, 4050}, UP} };
+
+    State st = new_state(board_size, starts, 2);
+    if (register_rules(&st)) exit(EXIT_FAILURE);
+    Governor g;
+    init_governor(&g, target_rate >= 0 ? target_rate : 0);
+    Server *s = start_server(&st, &g, path);
+    if (!s) exit(EXIT_FAILURE);
+
+    signal(SIGINT, stop_serving);
+    signal(SIGTERM, stop_serving);
+    printf("Serving on %s, attach with ./viewer %s\n", path, path);
+
+    while (serving) {
+        run_frame(&st, &g);
+        publish_frame(s);
+    }
+
+    stop_server(s);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *serve_path = NULL;
+    const char *metrics_path = NULL;
+    int metrics_every = 1;
+    MetricsPolicy metrics_policy = METRICS_DROP;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--serve") == 0) {
+            serve_path = DEFAULT_SOCKET_PATH;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) serve_path = argv[++i];
+        } else if (strcmp(argv[i], "--trail") == 0) {
+            with_trail = 1;
+        } else if (strcmp(argv[i], "--walk") == 0) {
+            with_walk = 1;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            with_watch = 1;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            target_rate = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-every") == 0 && i + 1 < argc) {
+            metrics_every = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics-block") == 0) {
+            metrics_policy = METRICS_BLOCK;
+        } else {
+            fprintf(stderr, "Usage: %s [--serve [socket]] [--trail] [--walk] [--watch] [--seed n] [--speed steps/sec]\n"
+                            "          [--metrics file] [--metrics-every n] [--metrics-block]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (metrics_path) {
+        metrics = start_metrics(metrics_path, metrics_every, metrics_policy);
+        if (!metrics) exit(EXIT_FAILURE);
+    }
+
+    if (serve_path) {
+        main_serve(serve_path);
+    } else {
+        main_vis();
+    }
+    stop_metrics(metrics);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "field.h"
+
+// Cache blocking: a band of rows is swept one column block at a time, so
+// the three input rows of the stencil stay in L1 while a block is written.
+// 1024 floats * 3 rows = 12KB.
+#define FIELD_BLOCK_COLS 1024
+#define FIELD_BLOCK_ROWS 32
+
+// Below this many cells a tick is cheaper than waking the thread team
+#define FIELD_PARALLEL_CELLS (1 << 16)
+
+int add_field(State *st, float decay, float diffusion) {
+    size_t cells = (size_t)st->size.x * st->size.y;
+    Field *newmem = realloc(st->fields, (st->field_len + 1) * sizeof(Field));
+    if (newmem == NULL) {
+        perror("add_field realloc");
+        return -1;
+    }
+    st->fields = newmem;
+
+    // calloc'd pages stay unbacked until the active region reaches them
+    Field *f = &st->fields[st->field_len];
+    f->data = calloc(cells, sizeof(float));
+    f->scratch = calloc(cells, sizeof(float));
+    if (!f->data || !f->scratch) {
+        perror("add_field calloc");
+        free(f->data);
+        free(f->scratch);
+        return -1;
+    }
+    f->decay = decay;
+    f->diffusion = diffusion;
+    f->display_max = 1.0f;
+    f->lo = f->hi = (Coordinate){0, 0};
+    f->back_lo = f->back_hi = (Coordinate){0, 0};
+    return st->field_len++;
+}
+
+float field_get(State *st, int field, Coordinate c) {
+    if (c.x < 0 || c.y < 0 || c.x >= st->size.x || c.y >= st->size.y) return 0;
+    return st->fields[field].data[(size_t)c.y * st->size.x + c.x];
+}
+
+// Writes must go through here so the active region covers them
+void field_add(State *st, int field, Coordinate c, float amount) {
+    if (c.x < 0 || c.y < 0 || c.x >= st->size.x || c.y >= st->size.y) return;
+    Field *f = &st->fields[field];
+    f->data[(size_t)c.y * st->size.x + c.x] += amount;
+
+    if (f->lo.x >= f->hi.x) {
+        f->lo = c;
+        f->hi = (Coordinate){c.x + 1, c.y + 1};
+        return;
+    }
+    if (c.x < f->lo.x) f->lo.x = c.x;
+    if (c.y < f->lo.y) f->lo.y = c.y;
+    if (c.x >= f->hi.x) f->hi.x = c.x + 1;
+    if (c.y >= f->hi.y) f->hi.y = c.y + 1;
+}
+
+static inline float flush(float v) {
+    return v < FIELD_EPSILON ? 0.0f : v;
+}
+
+// One row of the 5-point stencil over [x0, x1). Neighbours past the board
+// edge reflect back onto the cell itself, so diffusion conserves mass.
+static void stencil_row(const float *restrict up, const float *restrict mid, const float *restrict down,
+                        float *restrict out, int x0, int x1, int width, float k_self, float k_nb) {
+    int lo = x0 > 0 ? x0 : 1;
+    int hi = x1 < width - 1 ? x1 : width - 1;
+
+    if (x0 == 0) {
+        int r = width > 1 ? 1 : 0;
+        out[0] = flush(k_self * mid[0] + k_nb * (mid[0] + mid[r] + up[0] + down[0]));
+    }
+
+    #pragma omp simd
+    for (int x = lo; x < hi; x++) {
+        out[x] = flush(k_self * mid[x] + k_nb * (mid[x - 1] + mid[x + 1] + up[x] + down[x]));
+    }
+
+    if (x1 == width && width > 1) {
+        int x = width - 1;
+        out[x] = flush(k_self * mid[x] + k_nb * (mid[x - 1] + mid[x] + up[x] + down[x]));
+    }
+}
+
+static int row_empty(const float *row, int x0, int x1) {
+    float m = 0;
+    #pragma omp simd reduction(max:m)
+    for (int x = x0; x < x1; x++) m = row[x] > m ? row[x] : m;
+    return m == 0;
+}
+
+static int col_empty(const float *data, int width, int x, int y0, int y1) {
+    for (int y = y0; y < y1; y++) {
+        if (data[(size_t)y * width + x] != 0) return 0;
+    }
+    return 1;
+}
+
+// Peel fully decayed rows and columns off the edges of the active region
+static void trim_region(Field *f, int width) {
+    while (f->lo.y < f->hi.y && row_empty(&f->data[(size_t)f->lo.y * width], f->lo.x, f->hi.x)) f->lo.y++;
+    while (f->lo.y < f->hi.y && row_empty(&f->data[(size_t)(f->hi.y - 1) * width], f->lo.x, f->hi.x)) f->hi.y--;
+    while (f->lo.x < f->hi.x && col_empty(f->data, width, f->lo.x, f->lo.y, f->hi.y)) f->lo.x++;
+    while (f->lo.x < f->hi.x && col_empty(f->data, width, f->hi.x - 1, f->lo.y, f->hi.y)) f->hi.x--;
+
+    if (f->lo.x >= f->hi.x || f->lo.y >= f->hi.y) {
+        f->lo = f->hi = (Coordinate){0, 0};
+    }
+}
+
+static void step_field(Field *f, Coordinate size) {
+    if (f->lo.x >= f->hi.x) return;
+
+    int width = size.x, height = size.y;
+    float k_self = (1 - f->decay) * (1 - f->diffusion);
+    float k_nb = (1 - f->decay) * f->diffusion / 4;
+
+    // Diffusion can only reach one cell past the current region
+    int x0 = f->lo.x > 0 ? f->lo.x - 1 : 0;
+    int y0 = f->lo.y > 0 ? f->lo.y - 1 : 0;
+    int x1 = f->hi.x < width ? f->hi.x + 1 : width;
+    int y1 = f->hi.y < height ? f->hi.y + 1 : height;
+
+    // The back buffer must end up zero outside the new region, so also
+    // sweep (and clear) whatever it held from the previous tick
+    if (f->back_lo.x < f->back_hi.x) {
+        if (f->back_lo.x < x0) x0 = f->back_lo.x;
+        if (f->back_lo.y < y0) y0 = f->back_lo.y;
+        if (f->back_hi.x > x1) x1 = f->back_hi.x;
+        if (f->back_hi.y > y1) y1 = f->back_hi.y;
+    }
+
+    int bands = (y1 - y0 + FIELD_BLOCK_ROWS - 1) / FIELD_BLOCK_ROWS;
+    int blocks = (x1 - x0 + FIELD_BLOCK_COLS - 1) / FIELD_BLOCK_COLS;
+    size_t cells = (size_t)(x1 - x0) * (y1 - y0);
+    const float *in = f->data;
+    float *out = f->scratch;
+
+    #pragma omp parallel for collapse(2) schedule(static) if(cells > FIELD_PARALLEL_CELLS)
+    for (int band = 0; band < bands; band++) {
+        for (int block = 0; block < blocks; block++) {
+            int by0 = y0 + band * FIELD_BLOCK_ROWS;
+            int by1 = by0 + FIELD_BLOCK_ROWS < y1 ? by0 + FIELD_BLOCK_ROWS : y1;
+            int bx0 = x0 + block * FIELD_BLOCK_COLS;
+            int bx1 = bx0 + FIELD_BLOCK_COLS < x1 ? bx0 + FIELD_BLOCK_COLS : x1;
+
+            for (int y = by0; y < by1; y++) {
+                const float *mid = &in[(size_t)y * width];
+                const float *down = y > 0 ? mid - width : mid;
+                const float *up = y < height - 1 ? mid + width : mid;
+                stencil_row(up, mid, down, &out[(size_t)y * width], bx0, bx1, width, k_self, k_nb);
+            }
+        }
+    }
+
+    f->back_lo = f->lo;
+    f->back_hi = f->hi;
+    f->scratch = f->data;
+    f->data = out;
+    f->lo = (Coordinate){x0, y0};
+    f->hi = (Coordinate){x1, y1};
+    trim_region(f, width);
+}
+
+void step_fields(State *st) {
+    for (int i = 0; i < st->field_len; i++) {
+        step_field(&st->fields[i], st->size);
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "sim.h"
+
+// Values below this are flushed to zero so the active region can shrink
+#define FIELD_EPSILON 1e-4f
+
+int add_field(State *st, float decay, float diffusion);
+float field_get(State *st, int field, Coordinate c);
+void field_add(State *st, int field, Coordinate c, float amount);
+void step_fields(State *st);
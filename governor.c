@@ -0,0 +1,142 @@
+#include <unistd.h>
+#include <time.h>
+#include "governor.h"
+
+// Monotonic clock in seconds
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void init_governor(Governor *g, double target_rate) {
+    double now = now_seconds();
+    g->target_rate = target_rate;
+    g->paused = 0;
+    g->steps_pending = 0;
+    g->rewind_pending = 0;
+    g->rewind_failed = 0;
+    g->achieved_rate = 0;
+    g->step_cost = 1e-6;
+    g->credit = 0;
+    g->next_frame = g->last_frame = g->frame_start = now;
+    g->window_start = now;
+    g->window_steps = 0;
+}
+
+// Returns the number of steps to run this frame, sleeping first if the
+// previous frame finished early. Unbounded runs never sleep.
+int begin_frame(Governor *g) {
+    double now = now_seconds();
+    int paused = is_paused(g);
+    double target_rate = get_target_rate(g);
+
+    if (paused || target_rate > 0) {
+        if (g->next_frame > now) {
+            usleep((useconds_t)((g->next_frame - now) * 1e6));
+            now = now_seconds();
+        }
+        // Don't try to catch up on frames missed while falling behind
+        g->next_frame = now - g->next_frame > GOVERNOR_FRAME_INTERVAL ?
+            now + GOVERNOR_FRAME_INTERVAL : g->next_frame + GOVERNOR_FRAME_INTERVAL;
+    }
+
+    double elapsed = now - g->last_frame;
+    g->last_frame = g->frame_start = now;
+
+    // As many steps as fit in one frame at the measured cost
+    double budget = GOVERNOR_FRAME_INTERVAL / g->step_cost;
+    if (budget < 1) budget = 1;
+    if (budget > 1e9) budget = 1e9;
+
+    if (paused) {
+        g->credit = 0;
+        int n = take_steps(g);
+        if (n > budget) {
+            request_steps(g, n - (int)budget);
+            n = (int)budget;
+        }
+        return n;
+    }
+    if (target_rate <= 0) {
+        return (int)budget;
+    }
+
+    // Owed steps beyond one frame's budget are forgiven, so a target the
+    // engine can't reach doesn't build an ever-growing backlog
+    g->credit += target_rate * elapsed;
+    if (g->credit > budget) g->credit = budget;
+    int n = (int)g->credit;
+    g->credit -= n;
+    return n;
+}
+
+void end_frame(Governor *g, int steps) {
+    double now = now_seconds();
+    double spent = now - g->frame_start;
+
+    if (steps > 0 && spent > 0) {
+        g->step_cost = 0.8 * g->step_cost + 0.2 * (spent / steps);
+    }
+
+    g->window_steps += steps;
+    if (now - g->window_start >= GOVERNOR_RATE_WINDOW) {
+        set_achieved_rate(g, g->window_steps / (now - g->window_start));
+        g->window_start = now;
+        g->window_steps = 0;
+    }
+}
+
+// Scale the target rate; an unbounded run starts from what it achieves
+void change_speed(Governor *g, double factor) {
+    double rate = get_target_rate(g);
+    if (rate <= 0) rate = get_achieved_rate(g);
+    rate *= factor;
+    if (rate < 1) rate = 1;
+    if (rate > 1e9) rate = 1e9;
+    set_target_rate(g, rate);
+}
+
+void request_steps(Governor *g, int steps) {
+    __atomic_add_fetch(&g->steps_pending, steps, __ATOMIC_ACQ_REL);
+}
+
+void request_rewind(Governor *g, int steps) {
+    __atomic_add_fetch(&g->rewind_pending, steps, __ATOMIC_ACQ_REL);
+}
+
+int take_steps(Governor *g) {
+    return __atomic_exchange_n(&g->steps_pending, 0, __ATOMIC_ACQ_REL);
+}
+
+int take_rewind(Governor *g) {
+    return __atomic_exchange_n(&g->rewind_pending, 0, __ATOMIC_ACQ_REL);
+}
+
+double get_target_rate(Governor *g) {
+    double rate;
+    __atomic_load(&g->target_rate, &rate, __ATOMIC_ACQUIRE);
+    return rate;
+}
+
+void set_target_rate(Governor *g, double rate) {
+    __atomic_store(&g->target_rate, &rate, __ATOMIC_RELEASE);
+}
+
+int is_paused(Governor *g) {
+    return __atomic_load_n(&g->paused, __ATOMIC_ACQUIRE);
+}
+
+void set_paused(Governor *g, int paused) {
+    __atomic_store_n(&g->paused, paused, __ATOMIC_RELEASE);
+}
+
+double get_achieved_rate(Governor *g) {
+    double rate;
+    __atomic_load(&g->achieved_rate, &rate, __ATOMIC_ACQUIRE);
+    return rate;
+}
+
+void set_achieved_rate(Governor *g, double rate) {
+    __atomic_store(&g->achieved_rate, &rate, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Paces the simulation loop. Each frame the loop asks begin_frame how many
+// advance_state calls to make, runs them, publishes the state once and
+// reports back with end_frame. Batches are sized from the measured cost of
+// a step so a frame's worth of work never takes much longer than a frame.
+
+#define GOVERNOR_FRAME_INTERVAL (1.0 / 60.0)
+#define GOVERNOR_RATE_WINDOW 0.5  // Seconds averaged for achieved_rate
+
+// target_rate, paused and achieved_rate are shared with the input, server
+// or network threads, so go through the accessors below.
+typedef struct {
+    double target_rate;     // Steps per second, 0 for unbounded
+    int paused;
+    int steps_pending;      // Single steps requested while paused
+    int rewind_pending;     // Iterations to step back
+    int rewind_failed;      // Set when a rule without an inverse blocked a rewind
+    double achieved_rate;   // Measured steps per second
+    double step_cost;       // Smoothed seconds per step
+    double credit;          // Steps owed at the target rate
+    double next_frame, last_frame, frame_start;
+    double window_start;
+    long window_steps;
+} Governor;
+
+double now_seconds(void);
+void init_governor(Governor *g, double target_rate);
+int begin_frame(Governor *g);
+void end_frame(Governor *g, int steps);
+void change_speed(Governor *g, double factor);
+void request_steps(Governor *g, int steps);
+void request_rewind(Governor *g, int steps);
+int take_steps(Governor *g);
+int take_rewind(Governor *g);
+double get_target_rate(Governor *g);
+void set_target_rate(Governor *g, double rate);
+int is_paused(Governor *g);
+void set_paused(Governor *g, int paused);
+double get_achieved_rate(Governor *g);
+void set_achieved_rate(Governor *g, double rate);
@@ -2,6 +2,7 @@
 
 const Coordinate left = {-1, 0};
 const Coordinate right = {1, 0};
+const Coordinate back = {0, -1};
 
 int langton_condition(State *st, int pos_index) {
     return 1;
@@ -10,15 +11,33 @@ int langton_condition(State *st, int pos_index) {
 void langton_exec(State *st, int pos_index) {
     int x = st->positions[pos_index].coordinate.x, y = st->positions[pos_index].coordinate.y;
     if (st->board[y][x]) {
-        st->board[y][x] = 0;
+        set_cell(st, x, y, 0);
         move(&(st->positions[pos_index]), left);
     } else {
-        st->board[y][x] = 1;
+        set_cell(st, x, y, 1);
         move(&(st->positions[pos_index]), right);
     }
+    wrap(st, &st->positions[pos_index].coordinate);
 }
 
-const Behavior langton = { langton_condition, langton_exec };
+// The ant always leaves the cell it flipped by moving forward, so step back
+// without turning, read which way the cell was flipped, then undo the turn
+void langton_inverse(State *st, int pos_index) {
+    Position *pos = &st->positions[pos_index];
+    move(pos, back);
+    wrap(st, &pos->coordinate);
+
+    int x = pos->coordinate.x, y = pos->coordinate.y;
+    if (st->board[y][x]) {
+        set_cell(st, x, y, 0);
+        pos->direction = (pos->direction + 3) % 4;
+    } else {
+        set_cell(st, x, y, 1);
+        pos->direction = (pos->direction + 1) % 4;
+    }
+}
+
+const Behavior langton = { langton_condition, langton_exec, langton_inverse };
 
 int register_langton(State *st) {
     int initial_rules = st->rule_len;
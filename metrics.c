@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include "metrics.h"
+#include "governor.h"
+
+static void write_csv(FILE *out, const MetricsRecord *rec) {
+    if (rec->kind == RECORD_STEP) {
+        fprintf(out, "step,%u,%.6f,%.1f,%lld,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+            rec->iteration, rec->step.time, rec->step.steps_per_sec,
+            (long long)rec->step.population, rec->step.position_len,
+            rec->step.position_records,
+            rec->step.lo.x, rec->step.lo.y, rec->step.hi.x, rec->step.hi.y,
+            rec->step.directions[UP], rec->step.directions[RIGHT],
+            rec->step.directions[DOWN], rec->step.directions[LEFT]);
+    } else {
+        fprintf(out, "pos,%u,%d,%d,%d,%s\n",
+            rec->iteration, rec->position.index,
+            rec->position.coordinate.x, rec->position.coordinate.y,
+            dir_str(rec->position.direction));
+    }
+}
+
+// Write up to METRICS_BATCH records; returns how many were consumed
+static size_t drain(Metrics *m) {
+    size_t head = __atomic_load_n(&m->head, __ATOMIC_ACQUIRE);
+    size_t tail = m->tail;
+    size_t n = head - tail;
+    if (n > METRICS_BATCH) n = METRICS_BATCH;
+
+    for (size_t i = 0; i < n; i++) {
+        const MetricsRecord *rec = &m->ring[(tail + i) & (METRICS_RING_SIZE - 1)];
+        if (m->format == METRICS_CSV) {
+            write_csv(m->out, rec);
+        } else {
+            fwrite(rec, sizeof(MetricsRecord), 1, m->out);
+        }
+    }
+
+    __atomic_store_n(&m->tail, tail + n, __ATOMIC_RELEASE);
+    m->written += n;
+    return n;
+}
+
+static void *metrics_thread(void *arg) {
+    Metrics *m = arg;
+
+    while (!__atomic_load_n(&m->should_exit, __ATOMIC_ACQUIRE)) {
+        if (drain(m) == 0) {
+            // Idle: push what we have to disk and wait for more
+            fflush(m->out);
+            usleep(1000);
+        }
+    }
+    while (drain(m) > 0);
+    fflush(m->out);
+    return NULL;
+}
+
+// Format is chosen by extension: .csv for text, anything else is binary
+Metrics* start_metrics(const char *path, int every, MetricsPolicy policy) {
+    Metrics *m = malloc(sizeof(Metrics));
+    if (!m) return NULL;
+
+    m->out = fopen(path, "wb");
+    if (!m->out) {
+        perror("start_metrics fopen");
+        free(m);
+        return NULL;
+    }
+
+    const char *ext = strrchr(path, '.');
+    m->format = ext && strcmp(ext, ".csv") == 0 ? METRICS_CSV : METRICS_BINARY;
+    m->policy = policy;
+    m->every = every > 0 ? every : 1;
+    m->head = m->tail = 0;
+    m->should_exit = 0;
+    m->written = m->dropped = m->blocked = 0;
+    m->start_time = m->last_time = now_seconds();
+    m->last_iteration = 0;
+
+    if (m->format == METRICS_CSV) {
+        fprintf(m->out, "# step,iteration,time,steps_per_sec,population,positions,position_records,"
+                        "min_x,min_y,max_x,max_y,up,right,down,left\n");
+        fprintf(m->out, "# pos,iteration,index,x,y,direction\n");
+    }
+
+    if (pthread_create(&m->thread, NULL, metrics_thread, m)) {
+        perror("start_metrics pthread_create");
+        fclose(m->out);
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+// Wait (or give up, under METRICS_DROP) until n slots are free. A sample
+// is reserved as a whole so the file never holds a step record with
+// missing positions.
+static int reserve(Metrics *m, size_t n) {
+    size_t head = m->head;
+    size_t tail = __atomic_load_n(&m->tail, __ATOMIC_ACQUIRE);
+    if (head - tail + n <= METRICS_RING_SIZE) return 1;
+
+    if (m->policy == METRICS_DROP) {
+        m->dropped += n;
+        return 0;
+    }
+    m->blocked++;
+    do {
+        sched_yield();
+        tail = __atomic_load_n(&m->tail, __ATOMIC_ACQUIRE);
+    } while (head - tail + n > METRICS_RING_SIZE);
+    return 1;
+}
+
+static MetricsRecord *slot(Metrics *m, size_t i) {
+    MetricsRecord *rec = &m->ring[(m->head + i) & (METRICS_RING_SIZE - 1)];
+    memset(rec, 0, sizeof(*rec));
+    return rec;
+}
+
+// Called by the simulation loop after every step; only every Nth
+// iteration does any work. Records are built in place in the ring.
+void metrics_observe(Metrics *m, State *st) {
+    if (!m || st->iteration % m->every) return;
+
+    double now = now_seconds();
+    int n = st->position_len < METRICS_RING_SIZE ? st->position_len : METRICS_RING_SIZE - 1;
+    if (!reserve(m, n + 1)) return;
+
+    MetricsRecord *step = slot(m, 0);
+    step->kind = RECORD_STEP;
+    step->iteration = st->iteration;
+    step->step.time = now - m->start_time;
+    // A rewind moves the iteration backwards; restart the rate from here
+    if (st->iteration < m->last_iteration) {
+        m->last_iteration = st->iteration;
+        m->last_time = now;
+    }
+    step->step.steps_per_sec = now > m->last_time ?
+        (st->iteration - m->last_iteration) / (now - m->last_time) : 0;
+    step->step.population = st->population;
+    step->step.position_len = st->position_len;
+    step->step.position_records = n;
+
+    for (int i = 0; i < st->position_len; i++) {
+        Position *p = &st->positions[i];
+        if (i == 0 || p->coordinate.x < step->step.lo.x) step->step.lo.x = p->coordinate.x;
+        if (i == 0 || p->coordinate.y < step->step.lo.y) step->step.lo.y = p->coordinate.y;
+        if (i == 0 || p->coordinate.x > step->step.hi.x) step->step.hi.x = p->coordinate.x;
+        if (i == 0 || p->coordinate.y > step->step.hi.y) step->step.hi.y = p->coordinate.y;
+        step->step.directions[p->direction]++;
+
+        if (i < n) {
+            MetricsRecord *rec = slot(m, i + 1);
+            rec->kind = RECORD_POSITION;
+            rec->iteration = st->iteration;
+            rec->position.index = i;
+            rec->position.coordinate = p->coordinate;
+            rec->position.direction = p->direction;
+        }
+    }
+
+    __atomic_store_n(&m->head, m->head + n + 1, __ATOMIC_RELEASE);
+    m->last_time = now;
+    m->last_iteration = st->iteration;
+}
+
+void stop_metrics(Metrics *m) {
+    if (!m) return;
+
+    __atomic_store_n(&m->should_exit, 1, __ATOMIC_RELEASE);
+    pthread_join(m->thread, NULL);
+    fclose(m->out);
+    fprintf(stderr, "metrics: %llu records written, %llu dropped, producer blocked %llu times\n",
+        (unsigned long long)m->written, (unsigned long long)m->dropped,
+        (unsigned long long)m->blocked);
+    free(m);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "sim.h"
+
+// Asynchronous metrics time series. The simulation thread pushes
+// fixed-size records into a single-producer/single-consumer ring, and a
+// background thread batches them out to a file, so sampling never waits
+// on I/O (unless METRICS_BLOCK is chosen).
+
+#define METRICS_RING_SIZE 4096  // Records; must be a power of two
+#define METRICS_BATCH 256       // Records written per fwrite/flush pass
+
+typedef enum { METRICS_CSV, METRICS_BINARY } MetricsFormat;
+
+// What to do when the writer falls behind and the ring is full
+typedef enum { METRICS_DROP, METRICS_BLOCK } MetricsPolicy;
+
+typedef enum { RECORD_STEP, RECORD_POSITION } RecordKind;
+
+// One sample is a RECORD_STEP followed by one RECORD_POSITION per ant.
+// A sample must fit in the ring, so only the first METRICS_RING_SIZE - 1
+// ants get a position record; position_records says how many follow.
+// The binary format is these records back to back.
+typedef struct {
+    uint32_t kind;
+    uint32_t iteration;
+    union {
+        struct {
+            double time;            // Seconds since start_metrics
+            double steps_per_sec;   // Since the previous sample
+            int64_t population;
+            int32_t position_len;
+            int32_t position_records;  // RECORD_POSITIONs following this one
+            Coordinate lo, hi;      // Bounding box of the ants, inclusive
+            int32_t directions[4];  // Ants facing UP, RIGHT, DOWN, LEFT
+        } step;
+        struct {
+            int32_t index;
+            Coordinate coordinate;
+            int32_t direction;
+        } position;
+    };
+} MetricsRecord;
+
+typedef struct {
+    MetricsRecord ring[METRICS_RING_SIZE];
+    size_t head, tail;      // Written by producer / consumer only
+    FILE *out;
+    MetricsFormat format;
+    MetricsPolicy policy;
+    int every;              // Sample every N iterations
+    int should_exit;
+    uint64_t written, dropped, blocked;
+    double start_time, last_time;
+    int last_iteration;
+    pthread_t thread;
+} Metrics;
+
+Metrics* start_metrics(const char *path, int every, MetricsPolicy policy);
+void metrics_observe(Metrics *m, State *st);
+void stop_metrics(Metrics *m);
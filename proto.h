@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+
+// Wire protocol between the simulation server and out-of-process viewers.
+// Both ends run on the same host, so messages are sent in native byte
+// order with fixed-width fields laid out without padding.
+
+#define PROTO_MAGIC 0x58424d53  // "SMBX"
+#define PROTO_VERSION 6
+#define DEFAULT_SOCKET_PATH "/tmp/simbox.sock"
+
+// Server -> client, once after accepting a connection
+typedef struct {
+    uint32_t magic, version;
+    double target_rate;     // Current speed, so the viewer starts in sync
+    int32_t board_width, board_height;
+    int32_t field_count;
+    uint32_t paused;
+} HelloMsg;
+
+// Client -> server, once per frame
+typedef struct {
+    double target_rate;     // Steps per second, 0 for unbounded
+    int32_t x, y;           // Bottom-left world coordinate
+    float zoom;             // Cells per character
+    uint16_t cols, rows;    // Content size in characters
+    int32_t rewind;         // Iterations to step back before resuming
+    uint32_t paused;        // Nonzero to hold the simulation
+    int32_t steps;          // Single steps to take while paused
+    int32_t layer;          // 0 for the board, i to shade field i - 1
+    uint32_t braille;       // Nonzero for 2x4 Braille cells, ignoring zoom and layer
+    uint32_t reserved;      // Zero, keeps the size a multiple of 8
+} ViewRequest;
+
+// Server -> client, answering each ViewRequest. Followed by run_count runs
+// of changed tile cells, each encoded as a uint32 offset into the tile, a
+// uint16 length and that many uint16 cells, and then position_count
+// WirePositions. A change of cols/rows resets the client tile to empty.
+typedef struct {
+    double achieved_rate;   // Measured steps per second
+    uint32_t iteration;
+    uint32_t run_count;
+    uint32_t position_count;
+    uint16_t cols, rows;
+    uint32_t rewind_failed; // Nonzero once a rewind was refused (rule without an inverse)
+    uint32_t reserved;      // Zero, keeps the size a multiple of 8
+} FrameHeader;
+
+typedef struct {
+    int32_t x, y, direction;
+} WirePosition;
+
+int send_all(int fd, const void *buf, size_t len);
+int recv_all(int fd, void *buf, size_t len);
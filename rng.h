@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+#include "sim.h"
+
+// Counter-based RNG (Philox4x32-10). Every value is a pure function of
+// (seed, iteration, position index, draw), so rules get the same numbers
+// regardless of evaluation order, thread count or step batching, and the
+// numbers of a past iteration can be regenerated when rewinding.
+
+void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+uint32_t rng_u32(const State *st, int pos_index, uint32_t draw);
+float rng_uniform(const State *st, int pos_index, uint32_t draw);
+void rng_fill(const State *st, int first_index, int n, uint32_t draw, uint32_t *out);
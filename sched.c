@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+
+static Scheduler* create_scheduler(State *st) {
+    Scheduler *s = calloc(1, sizeof(Scheduler));
+    if (!s) return NULL;
+
+    int n = st->position_len;
+    s->words = (n + 63) / 64;
+    s->tiles_x = (st->size.x >> DIRTY_TILE_SHIFT) + 1;
+    s->tiles_y = (st->size.y >> DIRTY_TILE_SHIFT) + 1;
+    int tiles = s->tiles_x * s->tiles_y;
+
+    s->active = calloc(s->words ? s->words : 1, sizeof(uint64_t));
+    s->fired_at = malloc((n ? n : 1) * sizeof(int));
+    s->woken_at = malloc((n ? n : 1) * sizeof(int));
+    s->first_waiter = malloc((n ? n : 1) * sizeof(int));
+    s->tile_waiters = malloc(tiles * sizeof(int));
+    s->tile_dirty = calloc(tiles, 1);
+    s->dirty = malloc(tiles * sizeof(int));
+    s->free_waiter = -1;
+
+    if (!s->active || !s->fired_at || !s->woken_at || !s->first_waiter ||
+        !s->tile_waiters || !s->tile_dirty || !s->dirty) {
+        perror("create_scheduler");
+        free(s->active);
+        free(s->fired_at);
+        free(s->woken_at);
+        free(s->first_waiter);
+        free(s->tile_waiters);
+        free(s->tile_dirty);
+        free(s->dirty);
+        free(s);
+        return NULL;
+    }
+
+    // Everyone starts awake
+    for (int j = 0; j < n; j++) {
+        s->active[j / 64] |= 1ULL << (j % 64);
+        s->fired_at[j] = s->woken_at[j] = -1;
+        s->first_waiter[j] = -1;
+    }
+    for (int t = 0; t < tiles; t++) s->tile_waiters[t] = -1;
+    return s;
+}
+
+// The scheduler is only used when every rule declares its dependencies;
+// it is created the first time that holds
+int use_scheduler(State *st) {
+    if (st->rule_len == 0) return 0;
+    for (int i = 0; i < st->rule_len; i++) {
+        if (!st->rules[i].depends) return 0;
+    }
+    if (!st->scheduler) st->scheduler = create_scheduler(st);
+    return st->scheduler != NULL;
+}
+
+static int add_waiter(Scheduler *s, int position, int tile) {
+    int w = s->free_waiter;
+    if (w >= 0) {
+        s->free_waiter = s->waiters[w].next;
+    } else {
+        if (s->waiter_len == s->waiter_cap) {
+            int cap = s->waiter_cap ? s->waiter_cap * 2 : 64;
+            Waiter *newmem = realloc(s->waiters, cap * sizeof(Waiter));
+            if (!newmem) return -1;
+            s->waiters = newmem;
+            s->waiter_cap = cap;
+        }
+        w = s->waiter_len++;
+    }
+
+    Waiter *wt = &s->waiters[w];
+    wt->position = position;
+    wt->tile = tile;
+    wt->prev = -1;
+    wt->next = s->tile_waiters[tile];
+    if (wt->next >= 0) s->waiters[wt->next].prev = w;
+    s->tile_waiters[tile] = w;
+
+    wt->sibling = s->first_waiter[position];
+    s->first_waiter[position] = w;
+    return 0;
+}
+
+static void wake(State *st, int position) {
+    Scheduler *s = st->scheduler;
+
+    for (int w = s->first_waiter[position]; w >= 0;) {
+        Waiter *wt = &s->waiters[w];
+        if (wt->prev >= 0) s->waiters[wt->prev].next = wt->next;
+        else s->tile_waiters[wt->tile] = wt->next;
+        if (wt->next >= 0) s->waiters[wt->next].prev = wt->prev;
+
+        int sibling = wt->sibling;
+        wt->next = s->free_waiter;
+        s->free_waiter = w;
+        w = sibling;
+    }
+
+    s->first_waiter[position] = -1;
+    s->active[position / 64] |= 1ULL << (position % 64);
+    s->woken_at[position] = st->iteration;
+}
+
+static void wake_tile(State *st, int tile) {
+    Scheduler *s = st->scheduler;
+    while (s->tile_waiters[tile] >= 0) {
+        wake(st, s->waiters[s->tile_waiters[tile]].position);
+    }
+}
+
+// Put a position to sleep on the tiles covering every rule's dependencies.
+// If the waiters can't be allocated it simply stays awake.
+static void sleep_position(State *st, int position) {
+    Scheduler *s = st->scheduler;
+    Coordinate lo = {0, 0}, hi = {0, 0};
+
+    for (int i = 0; i < st->rule_len; i++) {
+        Coordinate rlo, rhi;
+        st->rules[i].depends(st, position, &rlo, &rhi);
+        if (rlo.x < 0) rlo.x = 0;
+        if (rlo.y < 0) rlo.y = 0;
+        if (rhi.x > st->size.x) rhi.x = st->size.x;
+        if (rhi.y > st->size.y) rhi.y = st->size.y;
+        if (rlo.x >= rhi.x || rlo.y >= rhi.y) continue;
+
+        if (lo.x >= hi.x) {
+            lo = rlo;
+            hi = rhi;
+            continue;
+        }
+        if (rlo.x < lo.x) lo.x = rlo.x;
+        if (rlo.y < lo.y) lo.y = rlo.y;
+        if (rhi.x > hi.x) hi.x = rhi.x;
+        if (rhi.y > hi.y) hi.y = rhi.y;
+    }
+
+    s->active[position / 64] &= ~(1ULL << (position % 64));
+    if (lo.x >= hi.x) return; // Depends on nothing: nothing can wake it
+
+    for (int ty = lo.y >> DIRTY_TILE_SHIFT; ty <= (hi.y - 1) >> DIRTY_TILE_SHIFT; ty++) {
+        for (int tx = lo.x >> DIRTY_TILE_SHIFT; tx <= (hi.x - 1) >> DIRTY_TILE_SHIFT; tx++) {
+            if (add_waiter(s, position, ty * s->tiles_x + tx)) {
+                wake(st, position);
+                return;
+            }
+        }
+    }
+}
+
+// Called by set_cell. Sleepers are woken immediately, so a sleeper with a
+// higher index than the writer still runs in the current pass, exactly as
+// it would have if it had been polled.
+void mark_dirty(State *st, int x, int y) {
+    Scheduler *s = st->scheduler;
+    int tile = (y >> DIRTY_TILE_SHIFT) * s->tiles_x + (x >> DIRTY_TILE_SHIFT);
+
+    if (!s->tile_dirty[tile]) {
+        s->tile_dirty[tile] = 1;
+        s->dirty[s->dirty_len++] = tile;
+    }
+    if (s->tile_waiters[tile] >= 0) wake_tile(st, tile);
+}
+
+// Iterate the awake positions in ascending order. The word is re-read
+// after every agent so positions woken mid-pass are still visited.
+#define FOR_EACH_ACTIVE(s, n, j, body) \
+    for (int w_ = 0; w_ < (s)->words; w_++) { \
+        uint64_t bits_ = (s)->active[w_]; \
+        while (bits_) { \
+            int b_ = __builtin_ctzll(bits_); \
+            int j = w_ * 64 + b_; \
+            if (j >= (n)) break; \
+            body \
+            bits_ = b_ == 63 ? 0 : (s)->active[w_] & (~0ULL << (b_ + 1)); \
+        } \
+    }
+
+void schedule_step(State *st) {
+    Scheduler *s = st->scheduler;
+    int it = st->iteration;
+
+    for (int i = 0; i < st->rule_len; i++) {
+        FOR_EACH_ACTIVE(s, st->position_len, j, {
+            if (st->rules[i].condition(st, j)) {
+                st->rules[i].execution(st, j);
+                s->fired_at[j] = it;
+            }
+        })
+    }
+
+    // Positions that did nothing, and haven't been woken since their last
+    // check, go to sleep
+    FOR_EACH_ACTIVE(s, st->position_len, j, {
+        if (s->fired_at[j] != it && s->woken_at[j] != it) sleep_position(st, j);
+    })
+
+    // A write this tick may have landed after a new sleeper's condition
+    // was checked; wake those to be safe
+    for (int d = 0; d < s->dirty_len; d++) {
+        wake_tile(st, s->dirty[d]);
+        s->tile_dirty[s->dirty[d]] = 0;
+    }
+    s->dirty_len = 0;
+}
+
+// Forget everything the scheduler knows, e.g. after rewinding
+void wake_all(State *st) {
+    Scheduler *s = st->scheduler;
+    if (!s) return;
+
+    for (int j = 0; j < st->position_len; j++) {
+        if (!(s->active[j / 64] & (1ULL << (j % 64)))) wake(st, j);
+    }
+    for (int d = 0; d < s->dirty_len; d++) s->tile_dirty[s->dirty[d]] = 0;
+    s->dirty_len = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include "sim.h"
+
+// Active-set scheduling. When every rule declares, through `depends`, the
+// board cells its condition reads, advance_state only polls agents that
+// are awake. An agent that no rule fired for during a tick goes to sleep,
+// registered as a waiter on the dirty tiles covering its cells, and is
+// woken by the next set_cell into one of those tiles.
+//
+// This gives the same results as polling every agent, provided each
+// condition depends only on the declared cells and the agent's own
+// Position (not on the iteration, the RNG or field layers).
+
+#define DIRTY_TILE_SHIFT 6  // Each dirty bit covers 64x64 cells
+
+typedef struct {
+    int position;
+    int tile;
+    int prev, next;         // Neighbours in the tile's waiter list
+    int sibling;            // Next waiter of the same position
+} Waiter;
+
+struct Scheduler {
+    int words;
+    uint64_t *active;       // One bit per position, set while awake
+    int *fired_at;          // Last iteration any rule fired for the position
+    int *woken_at;          // Last iteration the position was woken
+    int *first_waiter;      // Per position, chained through Waiter.sibling
+    int tiles_x, tiles_y;
+    int *tile_waiters;      // Per tile, head of its waiter list
+    unsigned char *tile_dirty;
+    int *dirty, dirty_len;  // Tiles written during the current tick
+    Waiter *waiters;
+    int waiter_len, waiter_cap, free_waiter;
+};
+
+int use_scheduler(State *st);
+void schedule_step(State *st);
+void mark_dirty(State *st, int x, int y);
+void wake_all(State *st);
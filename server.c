@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "server.h"
+#include "proto.h"
+
+// Unchanged gaps shorter than this are resent rather than starting a new
+// run, since a run header costs as much as three cells
+#define RUN_MERGE_GAP 3
+
+// Encode the cells of cur that differ from prev as runs into out, returning
+// the number of bytes written. out must hold at least 6 + cells*8 bytes.
+static size_t encode_runs(const Tile *cur, const uint16_t *prev, unsigned char *out, uint32_t *run_count) {
+    size_t len = 0;
+    size_t n = (size_t)cur->cols * cur->rows;
+    *run_count = 0;
+
+    size_t i = 0;
+    while (i < n) {
+        if (prev && cur->cells[i] == prev[i]) {
+            i++;
+            continue;
+        }
+
+        // Extend the run until a long enough unchanged gap is found, or
+        // until taking cell j would make it longer than a uint16 length
+        size_t start = i, end = i + 1, gap = 0;
+        for (size_t j = i + 1; j < n && j + 1 - start <= UINT16_MAX; j++) {
+            if (prev && cur->cells[j] == prev[j]) {
+                if (++gap >= RUN_MERGE_GAP) break;
+            } else {
+                gap = 0;
+                end = j + 1;
+            }
+        }
+
+        uint32_t offset = start;
+        uint16_t run_len = end - start;
+        memcpy(out + len, &offset, sizeof(offset));
+        memcpy(out + len + sizeof(offset), &run_len, sizeof(run_len));
+        len += sizeof(offset) + sizeof(run_len);
+        memcpy(out + len, &cur->cells[start], run_len * sizeof(uint16_t));
+        len += run_len * sizeof(uint16_t);
+
+        ++*run_count;
+        i = end;
+    }
+    return len;
+}
+
+// Called by the simulation loop once per frame, between steps
+void publish_frame(Server *s) {
+    State *st = s->state;
+
+    pthread_mutex_lock(&s->frame_lock);
+    Frame *f = s->frame;
+    if (f && !f->ready) {
+        sample_tile(f->tile, st);
+
+        f->ready = 1;
+        if (st->position_len > f->wire_len) {
+            WirePosition *w = realloc(f->wire, st->position_len * sizeof(WirePosition));
+            if (w) {
+                f->wire = w;
+                f->wire_len = st->position_len;
+            } else {
+                f->ready = -1;
+            }
+        }
+        if (f->ready > 0) {
+            for (int i = 0; i < st->position_len; i++) {
+                f->wire[i].x = st->positions[i].coordinate.x;
+                f->wire[i].y = st->positions[i].coordinate.y;
+                f->wire[i].direction = st->positions[i].direction;
+            }
+            f->position_count = st->position_len;
+            f->iteration = st->iteration;
+        }
+        pthread_cond_signal(&s->frame_cond);
+    }
+    pthread_mutex_unlock(&s->frame_lock);
+}
+
+// Post f and wait for the simulation loop to fill it
+static int wait_for_frame(Server *s, Frame *f) {
+    pthread_mutex_lock(&s->frame_lock);
+    f->ready = 0;
+    s->frame = f;
+    while (!f->ready && !s->should_exit) {
+        pthread_cond_wait(&s->frame_cond, &s->frame_lock);
+    }
+    s->frame = NULL;
+    pthread_mutex_unlock(&s->frame_lock);
+    return f->ready > 0 ? 0 : -1;
+}
+
+static void serve_client(Server *s, int fd) {
+    State *st = s->state;
+    Governor *g = s->governor;
+    HelloMsg hello = { PROTO_MAGIC, PROTO_VERSION, get_target_rate(g),
+                       st->size.x, st->size.y, st->field_len, is_paused(g) };
+    if (send_all(fd, &hello, sizeof(hello))) return;
+
+    Tile tile = {0};
+    Frame frame = { .tile = &tile };
+    uint16_t *prev = NULL;
+    unsigned char *runs = NULL;
+    ViewRequest req;
+
+    while (!__atomic_load_n(&s->should_exit, __ATOMIC_ACQUIRE) && recv_all(fd, &req, sizeof(req)) == 0) {
+        // Viewers only offer this range, so anything else (or NaN) is a bad
+        // client; a huge zoom would keep this thread sampling indefinitely
+        if (!(req.zoom >= TILE_MIN_ZOOM && req.zoom <= TILE_MAX_ZOOM)) {
+            fprintf(stderr, "serve_client: zoom %g out of range\n", req.zoom);
+            break;
+        }
+
+        // Controls are applied by the simulation loop, never from here
+        set_paused(g, req.paused != 0);
+        set_target_rate(g, req.target_rate);
+        if (req.rewind > 0) request_rewind(g, req.rewind);
+        if (req.steps > 0) request_steps(g, req.steps);
+
+        int reset = req.cols != tile.cols || req.rows != tile.rows;
+        size_t n = (size_t)req.cols * req.rows;
+
+        if (reset) {
+            uint16_t *new_prev = realloc(prev, (n ? n : 1) * sizeof(uint16_t));
+            unsigned char *new_runs = realloc(runs, n * 8 + 6);
+            if (!new_prev || !new_runs || resize_tile(&tile, req.cols, req.rows)) {
+                free(new_prev ? new_prev : prev);
+                free(new_runs ? new_runs : runs);
+                prev = NULL;
+                runs = NULL;
+                break;
+            }
+            prev = new_prev;
+            runs = new_runs;
+        }
+
+        tile.x = req.x;
+        tile.y = req.y;
+        tile.zoom = req.zoom;
+        tile.layer = req.layer >= 0 ? req.layer : 0;
+        tile.braille = req.braille != 0;
+        if (wait_for_frame(s, &frame)) break;
+
+        // Diff against the last tile sent; a reset client starts from blank
+        FrameHeader hdr;
+        size_t runs_len = encode_runs(&tile, reset ? NULL : prev, runs, &hdr.run_count);
+        memcpy(prev, tile.cells, n * sizeof(uint16_t));
+
+        hdr.achieved_rate = get_achieved_rate(g);
+        hdr.rewind_failed = __atomic_load_n(&g->rewind_failed, __ATOMIC_ACQUIRE);
+        hdr.reserved = 0;
+        hdr.iteration = frame.iteration;
+        hdr.position_count = frame.position_count;
+        hdr.cols = tile.cols;
+        hdr.rows = tile.rows;
+
+        if (send_all(fd, &hdr, sizeof(hdr)) ||
+            send_all(fd, runs, runs_len) ||
+            send_all(fd, frame.wire, frame.position_count * sizeof(WirePosition))) {
+            break;
+        }
+    }
+
+    free_tile(&tile);
+    free(prev);
+    free(runs);
+    free(frame.wire);
+}
+
+static void *server_thread(void *arg) {
+    Server *s = arg;
+
+    // One viewer at a time; a detached viewer frees the slot for the next
+    while (!__atomic_load_n(&s->should_exit, __ATOMIC_ACQUIRE)) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        __atomic_store_n(&s->client_fd, fd, __ATOMIC_RELEASE);
+        serve_client(s, fd);
+        __atomic_store_n(&s->client_fd, -1, __ATOMIC_RELEASE);
+        set_paused(s->governor, 0); // Don't leave the run frozen once the viewer detaches
+        close(fd);
+    }
+    return NULL;
+}
+
+Server* start_server(State *st, Governor *g, const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "start_server: socket path too long\n");
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+
+    Server *s = malloc(sizeof(Server));
+    if (!s) return NULL;
+    s->state = st;
+    s->should_exit = 0;
+    s->client_fd = -1;
+    s->governor = g;
+    s->path = strdup(path);
+    s->frame = NULL;
+    pthread_mutex_init(&s->frame_lock, NULL);
+    pthread_cond_init(&s->frame_cond, NULL);
+
+    s->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) {
+        perror("start_server socket");
+        goto fail;
+    }
+
+    // Only replace a stale socket, never an ordinary file
+    struct stat sb;
+    if (lstat(path, &sb) == 0) {
+        if (!S_ISSOCK(sb.st_mode)) {
+            fprintf(stderr, "start_server: %s exists and is not a socket\n", path);
+            close(s->listen_fd);
+            goto fail;
+        }
+        unlink(path);
+    }
+    if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(s->listen_fd, 1)) {
+        perror("start_server bind");
+        close(s->listen_fd);
+        goto fail;
+    }
+
+    if (pthread_create(&s->thread, NULL, server_thread, s)) {
+        perror("start_server pthread_create");
+        close(s->listen_fd);
+        unlink(path);
+        goto fail;
+    }
+    return s;
+
+fail:
+    pthread_mutex_destroy(&s->frame_lock);
+    pthread_cond_destroy(&s->frame_cond);
+    free(s->path);
+    free(s);
+    return NULL;
+}
+
+void stop_server(Server *s) {
+    if (!s) return;
+
+    // Release a server thread waiting on a frame that won't be published
+    pthread_mutex_lock(&s->frame_lock);
+    __atomic_store_n(&s->should_exit, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&s->frame_cond);
+    pthread_mutex_unlock(&s->frame_lock);
+
+    shutdown(s->listen_fd, SHUT_RDWR);
+    int client_fd = __atomic_load_n(&s->client_fd, __ATOMIC_ACQUIRE);
+    if (client_fd >= 0) shutdown(client_fd, SHUT_RDWR);
+    pthread_join(s->thread, NULL);
+    close(s->listen_fd);
+    unlink(s->path);
+    pthread_mutex_destroy(&s->frame_lock);
+    pthread_cond_destroy(&s->frame_cond);
+    free(s->path);
+    free(s);
+}
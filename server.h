@@ -0,0 +1,40 @@
+#pragma once
+#include <pthread.h>
+#include "sim.h"
+#include "tile.h"
+#include "governor.h"
+#include "proto.h"
+
+typedef struct Server Server;
+
+// A view handed from the server thread to the simulation thread to be
+// sampled, and back once it has been
+typedef struct {
+    Tile *tile;             // Viewport to sample
+    WirePosition *wire;     // Positions at the same iteration
+    int wire_len;           // Allocated WirePositions
+    int position_count;
+    uint32_t iteration;
+    int ready;              // 1 once sampled, -1 if it couldn't be
+} Frame;
+
+// Serves downsampled views of a running simulation over a Unix domain
+// socket. The server thread never reads the state: it posts the frame a
+// viewer asked for and the simulation loop fills it in publish_frame,
+// between steps, so every frame is consistent and advance_state never
+// waits on a viewer.
+struct Server {
+    State *state;
+    char *path;
+    int listen_fd, client_fd;
+    int should_exit;
+    Governor *governor;     // Driven by the viewer's speed controls
+    pthread_mutex_t frame_lock;
+    pthread_cond_t frame_cond;
+    Frame *frame;           // Waiting to be sampled, NULL if none
+    pthread_t thread;
+};
+
+Server* start_server(State *st, Governor *g, const char *path);
+void publish_frame(Server *s);
+void stop_server(Server *s);
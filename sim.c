@@ -2,6 +2,8 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include "sim.h"
+#include "field.h"
+#include "sched.h"
 
 char* dir_str(Direction d) {
     switch (d) {
@@ -39,27 +41,91 @@ State new_state(Coordinate size, Position *starts, int num_pos) {
     int **board = calloc(size.y, sizeof(int*));
     for (int i = 0; i < size.y; ++i) board[i] = calloc(size.x, sizeof(int));
     
+    // One bit per cell, LSB first; the padding byte lets readers always
+    // load two bytes at once
+    int bits_stride = (size.x + 7) / 8 + 1;
+    uint8_t *bits = calloc((size_t)bits_stride * size.y, 1);
+
     State st;
     st.board = board;
+    st.bits = bits;
+    st.bits_stride = bits_stride;
+    st.size = size;
     st.positions = starts;
     st.position_len = num_pos;
     st.rules = NULL;
     st.rule_len = 0;
     st.iteration = 0;
+    st.population = 0;
+    st.seed = 0;
+    st.fields = NULL;
+    st.field_len = 0;
+    st.scheduler = NULL;
     return st;
 }
 
 void advance_state(State *state) {
-    for (int i = 0; i < state->rule_len; ++i) {
-        for (int j = 0; j < state->position_len; ++j) {
-            if (state->rules[i].condition(state, j)) {
-                state->rules[i].execution(state, j);
+    if (use_scheduler(state)) {
+        schedule_step(state);
+    } else {
+        for (int i = 0; i < state->rule_len; ++i) {
+            for (int j = 0; j < state->position_len; ++j) {
+                if (state->rules[i].condition(state, j)) {
+                    state->rules[i].execution(state, j);
+                }
             }
         }
     }
+    step_fields(state);
     ++state->iteration;
 }
 
+// Un-step n iterations in place. Every rule must supply an inverse, which
+// is called for every position (whether or not its condition held on the
+// way forward) in the reverse of the order advance_state used. Only the
+// board and positions are rewound: fields are dissipative and are left as
+// they are, so a run with fields doesn't return to its earlier state.
+int rewind_state(State *state, int n) {
+    for (int i = 0; i < state->rule_len; ++i) {
+        if (!state->rules[i].inverse) return -1;
+    }
+    if (n > state->iteration) n = state->iteration;
+
+    for (; n > 0; --n) {
+        // Inverses see the same iteration their execution did
+        --state->iteration;
+        for (int i = state->rule_len - 1; i >= 0; --i) {
+            for (int j = state->position_len - 1; j >= 0; --j) {
+                state->rules[i].inverse(state, j);
+            }
+        }
+    }
+    wake_all(state);
+    return 0;
+}
+
+// Rules should write the board through here so derived bookkeeping
+// (population, the bit-packed board, the scheduler's dirty tiles) stays
+// correct
+void set_cell(State *state, int x, int y, int value) {
+    int *cell = &state->board[y][x];
+    state->population += (value != 0) - (*cell != 0);
+    *cell = value;
+
+    uint8_t *byte = &state->bits[(size_t)y * state->bits_stride + (x >> 3)];
+    if (value) *byte |= 1 << (x & 7);
+    else *byte &= ~(1 << (x & 7));
+
+    if (state->scheduler) mark_dirty(state, x, y);
+}
+
+// Keep a coordinate that stepped off the board on it by wrapping around
+// the edges (the board is a torus)
+void wrap(State *state, Coordinate *c) {
+    c->x = (c->x + state->size.x) % state->size.x;
+    c->y = (c->y + state->size.y) % state->size.y;
+}
+
 void move(Position *pos, Coordinate vector) {
     int t;
     switch (pos->direction) {
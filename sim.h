@@ -1,10 +1,13 @@
 #pragma once
 #include <stdlib.h>
+#include <stdint.h>
 
 typedef struct Coordinate Coordinate;
 typedef enum Direction Direction;
 typedef struct Position Position;
 typedef struct Behavior Behavior;
+typedef struct Field Field;
+typedef struct Scheduler Scheduler;
 typedef struct State State;
 
 struct Coordinate {
@@ -23,13 +26,35 @@ struct Position {
 struct Behavior {
     int (*condition)(State*, int);
     void (*execution)(State*, int);
+    void (*inverse)(State*, int);   // Optional, undoes one execution
+    // Optional, the cells [lo, hi) the condition reads (see sched.h)
+    void (*depends)(State*, int, Coordinate *lo, Coordinate *hi);
+};
+
+// A continuous per-cell layer (e.g. pheromones) that decays and diffuses
+// every tick. Only cells inside [lo, hi) can be nonzero.
+struct Field {
+    float *data, *scratch;  // size.x * size.y, row-major; scratch is the back buffer
+    float decay;            // Fraction lost per tick
+    float diffusion;        // Fraction spread evenly to the 4 neighbours per tick
+    float display_max;      // Value rendered as a full block
+    Coordinate lo, hi;      // Active region, empty when lo.x >= hi.x
+    Coordinate back_lo, back_hi;  // Region where scratch may still be nonzero
 };
 
 struct State {
     int **board;
+    uint8_t *bits;          // Bit-packed copy of the board (1 = nonzero), kept by set_cell
+    int bits_stride;        // Bytes per row of bits, including one byte of padding
+    Coordinate size;
     int rule_len, position_len, iteration;
+    long population;        // Nonzero cells, kept up to date by set_cell
+    uint64_t seed;          // Keys the counter-based RNG (see rng.h)
     Position *positions;
     Behavior *rules;
+    int field_len;
+    Field *fields;
+    Scheduler *scheduler;   // Created on first use, see sched.h
 };
 
 // https://codeberg.org/NRK/slashtmp/src/branch/master/misc/safe_va_func.c
@@ -43,4 +68,7 @@ void add_rules_core(State *state, const Behavior *b, size_t n);
 char* dir_str(Direction d);
 State new_state(Coordinate size, Position *start, int num_positions);
 void advance_state(State *state);
+int rewind_state(State *state, int n);
+void set_cell(State *state, int x, int y, int value);
 void move(Position *pos, Coordinate vector);
+void wrap(State *state, Coordinate *c);
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tile.h"
+
+int resize_tile(Tile *t, int cols, int rows) {
+    if (t->cols == cols && t->rows == rows && t->cells) return 0;
+
+    uint16_t *cells = calloc((size_t)cols * rows, sizeof(uint16_t));
+    if (!cells) return -1;
+
+    free(t->cells);
+    t->cells = cells;
+    t->cols = cols;
+    t->rows = rows;
+    return 0;
+}
+
+void free_tile(Tile *t) {
+    free(t->cells);
+    t->cells = NULL;
+    t->cols = t->rows = 0;
+}
+
+// Fraction of the block [x, x + w) x [y, y + h) that is filled. For a field
+// layer it is the block's mean value relative to display_max instead.
+static float block_density(Tile *t, State *st, int x, int y, int w, int h) {
+    Field *f = t->layer > 0 ? &st->fields[t->layer - 1] : NULL;
+    float sum = 0;
+    int total_count = 0;
+
+    for (int world_y = y; world_y < y + h; world_y++) {
+        if (world_y < 0 || world_y >= st->size.y) continue;
+        for (int world_x = x; world_x < x + w; world_x++) {
+            if (world_x < 0 || world_x >= st->size.x) continue;
+            total_count++;
+            if (f) {
+                sum += f->data[(size_t)world_y * st->size.x + world_x];
+            } else {
+                sum += st->board[world_y][world_x] != 0;
+            }
+        }
+    }
+
+    if (total_count == 0) return 0;
+    return f ? sum / total_count / f->display_max : sum / total_count;
+}
+
+static int bit_at(State *st, int x, int y) {
+    if (x < 0 || y < 0 || x >= st->size.x || y >= st->size.y) return 0;
+    return (st->bits[(size_t)y * st->bits_stride + (x >> 3)] >> (x & 7)) & 1;
+}
+
+// Braille mode: each character is a 2x4 block read straight from the
+// bit-packed board. The glyph index packs the block row by row, two bits
+// per row with the top row lowest (see braille_chars for the dot order).
+static void sample_braille(Tile *t, State *st) {
+    for (int sy = 0; sy < t->rows; sy++) {
+        uint16_t *row = &t->cells[(size_t)sy * t->cols];
+        int top_y = t->y + (t->rows - sy) * BRAILLE_HEIGHT - 1;
+
+        // Rows of bits for each dot row, or NULL past the board
+        const uint8_t *lines[BRAILLE_HEIGHT];
+        for (int r = 0; r < BRAILLE_HEIGHT; r++) {
+            int y = top_y - r;
+            lines[r] = y >= 0 && y < st->size.y ? &st->bits[(size_t)y * st->bits_stride] : NULL;
+        }
+
+        for (int sx = 0; sx < t->cols; sx++) {
+            int x = t->x + sx * BRAILLE_WIDTH;
+            unsigned index = 0;
+
+            if (x >= 0 && x + 1 < st->size.x) {
+                // Both columns are on the board: one two-byte load per row
+                int byte = x >> 3, shift = x & 7;
+                for (int r = 0; r < BRAILLE_HEIGHT; r++) {
+                    if (!lines[r]) continue;
+                    unsigned pair = (lines[r][byte] | lines[r][byte + 1] << 8) >> shift;
+                    index |= (pair & 3) << (2 * r);
+                }
+            } else {
+                for (int r = 0; r < BRAILLE_HEIGHT; r++) {
+                    index |= bit_at(st, x, top_y - r) << (2 * r);
+                    index |= bit_at(st, x + 1, top_y - r) << (2 * r + 1);
+                }
+            }
+            row[sx] = index;
+        }
+    }
+
+    for (int i = 0; i < st->position_len; i++) {
+        Coordinate c = st->positions[i].coordinate;
+        int sx = (int)floorf((c.x - t->x) / (float)BRAILLE_WIDTH);
+        int sy = t->rows - 1 - (int)floorf((c.y - t->y) / (float)BRAILLE_HEIGHT);
+        if (sx >= 0 && sy >= 0 && sx < t->cols && sy < t->rows) {
+            t->cells[(size_t)sy * t->cols + sx] |= TILE_ACTIVE;
+        }
+    }
+}
+
+// Fill every tile cell from the board (or a field layer). At zoom <= 1 a
+// character is exactly one cell; when zoomed out a character covers a
+// ceil(zoom)^2 block and stores how full that block is.
+void sample_tile(Tile *t, State *st) {
+    if (t->braille) {
+        sample_braille(t, st);
+        return;
+    }
+
+    float zoom = t->zoom;
+    int block = zoom <= 1.0f ? 1 : (int)ceil(zoom);
+    float step = zoom <= 1.0f ? 1.0f : zoom;
+    if (t->layer > st->field_len) t->layer = 0;
+
+    for (int sy = 0; sy < t->rows; sy++) {
+        uint16_t *row = &t->cells[(size_t)sy * t->cols];
+        int start_y = t->y + (int)((t->rows - 1 - sy) * step);
+
+        for (int sx = 0; sx < t->cols; sx++) {
+            int start_x = t->x + (int)(sx * step);
+            float density = block_density(t, st, start_x, start_y, block, block);
+
+            // Round fields up so faint traces stay visible
+            int level = t->layer > 0 ? (int)ceilf(density * TILE_LEVELS)
+                                     : (int)(density * TILE_LEVELS);
+            if (level > TILE_LEVELS) level = TILE_LEVELS;
+            if (level < 0) level = 0;
+            row[sx] = level;
+        }
+    }
+
+    // Mark active coordinates once per position rather than once per cell
+    for (int i = 0; i < st->position_len; i++) {
+        Coordinate c = st->positions[i].coordinate;
+        int sx, sy;
+        if (zoom <= 1.0f) {
+            sx = c.x - t->x;
+            sy = t->rows - 1 - (c.y - t->y);
+        } else {
+            sx = (int)floorf((c.x - t->x) / zoom);
+            sy = t->rows - 1 - (int)floorf((c.y - t->y) / zoom);
+        }
+        if (sx >= 0 && sy >= 0 && sx < t->cols && sy < t->rows) {
+            t->cells[(size_t)sy * t->cols + sx] |= TILE_ACTIVE;
+        }
+    }
+}
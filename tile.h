@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include "sim.h"
+
+// Each tile cell holds a glyph index and an active flag, packed into 16
+// bits so tiles can be diffed and sent as-is. The glyph is a fill level
+// (index into block_chars) or, in Braille mode, a dot pattern (index into
+// braille_chars).
+#define TILE_ACTIVE 0x100
+#define TILE_GLYPH_MASK 0xff
+#define TILE_LEVELS 4
+
+// Zoom range a tile may be sampled at; sampling cost grows with zoom^2
+#define TILE_MIN_ZOOM 0.5f
+#define TILE_MAX_ZOOM 50.0f
+
+// Cells covered by one Braille character
+#define BRAILLE_WIDTH 2
+#define BRAILLE_HEIGHT 4
+
+typedef struct Tile Tile;
+
+// A downsampled view of the board: one cell per terminal character
+struct Tile {
+    int x, y;       // Bottom-left world coordinate
+    float zoom;     // Cells per character
+    int layer;      // 0 for the board, i for st->fields[i - 1]
+    int braille;    // 2x4 cells per character as Braille dots; ignores zoom and layer
+    int cols, rows;
+    uint16_t *cells;  // rows * cols, row 0 is the top of the view
+};
+
+int resize_tile(Tile *t, int cols, int rows);
+void free_tile(Tile *t);
+void sample_tile(Tile *t, State *st);
@@ -0,0 +1,34 @@
+#include "sim.h"
+#include "field.h"
+
+// Every ant drops pheromone on the cell it is standing on; the field layer
+// takes care of spreading and evaporating it
+
+const float trail_amount = 1.0f;
+static int trail_field = -1;
+
+int trail_condition(State *st, int pos_index) {
+    return 1;
+}
+
+void trail_exec(State *st, int pos_index) {
+    field_add(st, trail_field, st->positions[pos_index].coordinate, trail_amount);
+}
+
+// Only undoes the rule's effect on the board and positions, which is
+// nothing: fields aren't rewound (see rewind_state), so the pheromone keeps
+// its later value and is deposited again when the run moves forward
+void trail_inverse(State *st, int pos_index) {
+}
+
+const Behavior trail = { trail_condition, trail_exec, trail_inverse };
+
+int register_trail(State *st, float decay, float diffusion) {
+    trail_field = add_field(st, decay, diffusion);
+    if (trail_field < 0) return -1;
+
+    int initial_rules = st->rule_len;
+    add_rules(st, trail);
+    if (st->rule_len != initial_rules + 1) return -1;
+    return 0;
+}
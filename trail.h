@@ -0,0 +1,4 @@
+#pragma once
+#include "sim.h"
+
+int register_trail(State *st, float decay, float diffusion);
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <locale.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "proto.h"
+#include "vis.h"
+
+// Out-of-process viewer: renders frames served by `ant --serve`
+
+typedef struct {
+    Renderer *renderer;
+    int fd;
+    State view;         // Positions and iteration mirrored from the server
+    Governor governor;  // Mirror of the server's speed controls
+    Tile tile;          // Tile being assembled from received diffs
+    WirePosition *wire;
+    int wire_len;
+} Viewer;
+
+static int connect_server(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int receive_frame(Viewer *v, int braille) {
+    Renderer *r = v->renderer;
+    FrameHeader hdr;
+    if (recv_all(v->fd, &hdr, sizeof(hdr))) return -1;
+
+    // A size change means the server is sending a full tile
+    if (hdr.cols != v->tile.cols || hdr.rows != v->tile.rows) {
+        free_tile(&v->tile);
+        if (resize_tile(&v->tile, hdr.cols, hdr.rows)) return -1;
+    }
+
+    size_t n = (size_t)hdr.cols * hdr.rows;
+    for (uint32_t i = 0; i < hdr.run_count; i++) {
+        uint32_t offset;
+        uint16_t len;
+        if (recv_all(v->fd, &offset, sizeof(offset)) ||
+            recv_all(v->fd, &len, sizeof(len))) return -1;
+        if ((size_t)offset + len > n) return -1;
+        if (recv_all(v->fd, &v->tile.cells[offset], len * sizeof(uint16_t))) return -1;
+    }
+
+    if ((int)hdr.position_count > v->wire_len) {
+        WirePosition *w = realloc(v->wire, hdr.position_count * sizeof(WirePosition));
+        if (!w) return -1;
+        v->wire = w;
+        v->wire_len = hdr.position_count;
+    }
+    if (recv_all(v->fd, v->wire, hdr.position_count * sizeof(WirePosition))) return -1;
+
+    // Publish to the renderer in one short critical section
+    pthread_mutex_lock(&r->state_lock);
+    int ok = resize_tile(&r->tile, hdr.cols, hdr.rows) == 0;
+    if (ok) {
+        memcpy(r->tile.cells, v->tile.cells, n * sizeof(uint16_t));
+        r->tile.braille = braille;  // Tells the renderer how to draw the cells
+    }
+
+    if (ok && (int)hdr.position_count > v->view.position_len) {
+        Position *p = realloc(v->view.positions, hdr.position_count * sizeof(Position));
+        if (p) v->view.positions = p;
+        else ok = 0;
+    }
+    if (ok) {
+        for (uint32_t i = 0; i < hdr.position_count; i++) {
+            v->view.positions[i].coordinate.x = v->wire[i].x;
+            v->view.positions[i].coordinate.y = v->wire[i].y;
+            v->view.positions[i].direction = v->wire[i].direction;
+        }
+        v->view.position_len = hdr.position_count;
+        v->view.iteration = hdr.iteration;
+        set_achieved_rate(&v->governor, hdr.achieved_rate);
+        __atomic_store_n(&v->governor.rewind_failed, hdr.rewind_failed != 0, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&r->state_lock);
+
+    return ok ? 0 : -1;
+}
+
+static void *network_thread(void *arg) {
+    Viewer *v = arg;
+    Renderer *r = v->renderer;
+
+    while (!r->should_exit) {
+        double frame_start = now_seconds();
+
+        ViewRequest req;
+        pthread_mutex_lock(&r->render_lock);
+        int content_width = r->viewport.width - 2;
+        int content_height = r->viewport.height - 4;
+        req.x = r->viewport.x;
+        req.y = r->viewport.y;
+        req.zoom = r->viewport.zoom;
+        req.cols = content_width > 0 ? content_width : 0;
+        req.rows = content_height > 0 ? content_height : 0;
+        req.layer = r->layer;
+        req.braille = r->braille;
+        req.reserved = 0;
+        req.target_rate = get_target_rate(&v->governor);
+        req.paused = is_paused(&v->governor);
+        pthread_mutex_unlock(&r->render_lock);
+        req.rewind = take_rewind(&v->governor);
+        req.steps = take_steps(&v->governor);
+
+        if (send_all(v->fd, &req, sizeof(req)) || receive_frame(v, req.braille)) break;
+        update_state(r, &v->view);
+
+        // One request per frame is all the renderer can show
+        double wait = FRAME_INTERVAL - (now_seconds() - frame_start);
+        if (wait > 0) usleep((useconds_t)(wait * 1e6));
+    }
+
+    // Server went away: shut the renderer down too
+    r->should_exit = 1;
+    wake_renderer(r);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    setlocale(LC_ALL, "");
+    const char *path = argc > 1 ? argv[1] : DEFAULT_SOCKET_PATH;
+
+    int fd = connect_server(path);
+    if (fd < 0) {
+        perror("Connect to server");
+        exit(EXIT_FAILURE);
+    }
+
+    HelloMsg hello;
+    if (recv_all(fd, &hello, sizeof(hello)) ||
+        hello.magic != PROTO_MAGIC || hello.version != PROTO_VERSION) {
+        fprintf(stderr, "Unexpected handshake from %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    Renderer *r = create_renderer(hello.board_width, hello.board_height);
+    if (!r) {
+        perror("Create renderer");
+        exit(EXIT_FAILURE);
+    }
+    r->remote = 1;
+
+    Viewer v = { .renderer = r, .fd = fd };
+    v.view.size = (Coordinate){ hello.board_width, hello.board_height };
+    v.view.field_len = hello.field_count;  // Only used to cycle layers
+    init_governor(&v.governor, hello.target_rate);
+    set_paused(&v.governor, hello.paused);
+    r->governor = &v.governor;
+
+    pthread_t network;
+    pthread_create(&network, NULL, network_thread, &v);
+
+    start_renderer(r);
+
+    // Unblock a pending receive before joining
+    shutdown(fd, SHUT_RDWR);
+    pthread_join(network, NULL);
+    close(fd);
+
+    free_tile(&v.tile);
+    free(v.wire);
+    free(v.view.positions);
+    destroy_renderer(r);
+    return 0;
+}
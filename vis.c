@@ -4,6 +4,9 @@
 #include <pthread.h>
 #include <termios.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <signal.h>
 #include <math.h>
@@ -20,6 +23,34 @@ const char *block_chars[] = {
     "\u2588"       // 4/4 filled - █ Full block
 };
 
+char braille_chars[256][4];
+
+// Braille dot bit for each cell of the 2x4 block, by row (top first) and
+// column; U+2800 plus the dot bits is the pattern
+static const unsigned char braille_dots[BRAILLE_HEIGHT][BRAILLE_WIDTH] = {
+    {0x01, 0x08},
+    {0x02, 0x10},
+    {0x04, 0x20},
+    {0x40, 0x80},
+};
+
+// Build the lookup from a tile's glyph index (two bits per row, top row
+// lowest, left column first) to the UTF-8 encoding of its pattern
+void init_braille_chars(void) {
+    for (int index = 0; index < 256; index++) {
+        int dots = 0;
+        for (int r = 0; r < BRAILLE_HEIGHT; r++) {
+            for (int c = 0; c < BRAILLE_WIDTH; c++) {
+                if (index & (1 << (2 * r + c))) dots |= braille_dots[r][c];
+            }
+        }
+        braille_chars[index][0] = (char)0xE2;
+        braille_chars[index][1] = (char)(0xA0 | (dots >> 6));
+        braille_chars[index][2] = (char)(0x80 | (dots & 0x3F));
+        braille_chars[index][3] = '\0';
+    }
+}
+
 // Global renderer instance
 static Renderer *g_renderer = NULL;
 static struct termios orig_termios;
@@ -66,59 +97,53 @@ void render_character_at_position(Renderer *r, int screen_x, int screen_y, int c
         return;
     }
     
-    float cells_per_char = r->viewport.zoom;
+    // The tile may lag behind a resize when it is filled remotely
+    if (screen_x >= r->tile.cols || screen_y >= r->tile.rows) {
+        return;
+    }
     
-    if (cells_per_char <= 1.0) {
-        // Zoomed in: 1 character = 1 cell or less
-        int world_x = r->viewport.x + screen_x;
-        int world_y = r->viewport.y + (content_height - 1 - screen_y);
-        
-        int cell_value = get_cell_value(r, world_x, world_y);
-        int is_active = is_active_coordinate(r, world_x, world_y);
-        
-        // Store as UTF-8 string
-        strcpy(&r->screen_buffer[screen_y][screen_x * 8], cell_value ? "█" : " ");
-        r->color_buffer[screen_y][screen_x] = is_active ? 'R' : 'N';
+    uint16_t cell = r->tile.cells[screen_y * r->tile.cols + screen_x];
+    int glyph = cell & TILE_GLYPH_MASK;
+    
+    // Store UTF-8 block or Braille character
+    const char *block_char;
+    if (r->tile.braille) {
+        block_char = braille_chars[glyph];
     } else {
-        // Zoomed out: 1 character = multiple cells
-        int cells_wide = (int)ceil(cells_per_char);
-        int cells_high = (int)ceil(cells_per_char);
-        
-        int start_x = r->viewport.x + (int)(screen_x * cells_per_char);
-        int start_y = r->viewport.y + (int)((content_height - 1 - screen_y) * cells_per_char);
-        
-        int filled_count = 0;
-        int total_count = 0;
-        int has_active = 0;
-        
-        for (int dy = 0; dy < cells_high; dy++) {
-            for (int dx = 0; dx < cells_wide; dx++) {
-                int world_x = start_x + dx;
-                int world_y = start_y + dy;
-                
-                if (world_x >= 0 && world_y >= 0 && 
-                    world_x < r->board_width && world_y < r->board_height) {
-                    total_count++;
-                    if (get_cell_value(r, world_x, world_y)) {
-                        filled_count++;
-                    }
-                    if (is_active_coordinate(r, world_x, world_y)) {
-                        has_active = 1;
-                    }
-                }
-            }
-        }
-        
-        int fill_level = 0;
-        if (total_count > 0) {
-            fill_level = (filled_count * 4) / total_count;
-            if (fill_level > 4) fill_level = 4;
+        block_char = block_chars[glyph < TILE_LEVELS ? glyph : TILE_LEVELS];
+    }
+    strcpy(&r->screen_buffer[screen_y][screen_x * 8], block_char);
+    r->color_buffer[screen_y][screen_x] = (cell & TILE_ACTIVE) ? 'R' : 'N';
+}
+
+// Take everything a frame needs from the state: the tile under the viewport
+// (unless a server sends it) plus the figures shown and used by the keys.
+// Runs on the simulation thread between steps, the only time the state is
+// consistent. Caller must hold state_lock and render_lock.
+static void snapshot_state(Renderer *r, State *st) {
+    int content_width = r->viewport.width - 2;
+    int content_height = r->viewport.height - 4;
+    
+    if (!r->remote && content_width > 0 && content_height > 0 &&
+        resize_tile(&r->tile, content_width, content_height) == 0) {
+        r->tile.x = r->viewport.x;
+        r->tile.y = r->viewport.y;
+        r->tile.zoom = r->viewport.zoom;
+        r->tile.layer = r->layer;
+        r->tile.braille = r->braille;
+        sample_tile(&r->tile, st);
+    }
+    
+    r->iteration = st->iteration;
+    r->position_len = st->positions ? st->position_len : 0;
+    if (r->position_len > 0) {
+        long sum_x = 0, sum_y = 0;
+        for (int i = 0; i < r->position_len; i++) {
+            sum_x += st->positions[i].coordinate.x;
+            sum_y += st->positions[i].coordinate.y;
         }
-        
-        // Store UTF-8 block character
-        const char *block_char = block_chars[fill_level];
-        strcpy(&r->screen_buffer[screen_y][screen_x * 8], block_char);
-        r->color_buffer[screen_y][screen_x] = has_active ? 'R' : 'N';
+        r->centroid.x = sum_x / r->position_len;
+        r->centroid.y = sum_y / r->position_len;
     }
 }
 
@@ -182,14 +207,39 @@ void render_frame(Renderer *r) {
     MOVE_CURSOR(r->viewport.height - 1, 1);
     printf("\033[K"); // Clear from cursor to end of line
     printf("Pos: (%d,%d)", r->viewport.x, r->viewport.y);
+    if (r->current_state) {
+        printf("  Iter: %d", r->iteration);
+    }
+    if (r->layer > 0) {
+        printf("  Field: %d", r->layer - 1);
+    }
+    if (r->governor) {
+        Governor *g = r->governor;
+        double target = get_target_rate(g), achieved = get_achieved_rate(g);
+        if (target > 0) {
+            printf("  Speed: %.0f/s (%.0f/s)", target, achieved);
+        } else {
+            printf("  Speed: max (%.0f/s)", achieved);
+        }
+        if (is_paused(g)) {
+            printf("  [PAUSED]");
+        }
+        if (__atomic_load_n(&g->rewind_failed, __ATOMIC_ACQUIRE)) {
+            printf("  [NO REWIND]");
+        }
+    }
     MOVE_CURSOR(r->viewport.height - 1, r->viewport.width - 15);
     printf("\033[K"); // Clear from cursor to end of line
-    printf("Zoom: %.2fx\n", r->viewport.zoom);
+    if (r->braille) {
+        printf("Braille 2x4\n");
+    } else {
+        printf("Zoom: %.2fx\n", r->viewport.zoom);
+    }
     
     // Controls line in gray - centered
     MOVE_CURSOR(r->viewport.height, 1);
     printf("\033[K"); // Clear the entire line
-    const char *controls_text = "WASD:Pan +/-:Zoom C:Center Q:Quit";
+    const char *controls_text = "WASD:Pan +/-:Zoom M:Braille C:Center F:Field P:Pause N:Step b/B:Back </>:Speed U:Max Q:Quit";
     int controls_len = strlen(controls_text);
     int padding = (r->viewport.width - controls_len) / 2;
     if (padding > 0) {
@@ -203,69 +253,68 @@ void render_frame(Renderer *r) {
     pthread_mutex_unlock(&r->state_lock);
 }
 
-void signal_handler(int sig) {
-    if (sig == SIGWINCH) {
-        // Handle window resize
-        if (g_renderer) {
-            pthread_mutex_lock(&g_renderer->render_lock);
-            
-            // Store old dimensions before getting new ones
-            int old_content_height = g_renderer->viewport.height - 4;
-            
-            // Get new terminal size
-            get_terminal_size(&g_renderer->viewport.width, &g_renderer->viewport.height);
-            
-            // Free old buffers if they exist
-            if (g_renderer->screen_buffer) {
-                // Use the stored old content height, ensuring we don't go below 0
-                if (old_content_height > 0) {
-                    for (int i = 0; i < old_content_height; i++) {
-                        if (g_renderer->screen_buffer[i]) {
-                            free(g_renderer->screen_buffer[i]);
-                        }
-                        if (g_renderer->color_buffer[i]) {
-                            free(g_renderer->color_buffer[i]);
-                        }
-                    }
-                }
-                free(g_renderer->screen_buffer);
-                free(g_renderer->color_buffer);
-                g_renderer->screen_buffer = NULL;
-                g_renderer->color_buffer = NULL;
-            }
-            
-            // Allocate new buffers
-            int content_width = g_renderer->viewport.width - 2;
-            int content_height = g_renderer->viewport.height - 4;
-            
-            // Ensure we don't allocate negative or zero sized buffers
-            if (content_width > 0 && content_height > 0) {
-                g_renderer->screen_buffer = malloc(content_height * sizeof(char*));
-                g_renderer->color_buffer = malloc(content_height * sizeof(char*));
-                
-                for (int i = 0; i < content_height; i++) {
-                    g_renderer->screen_buffer[i] = calloc(content_width * 8 + 1, sizeof(char));
-                    g_renderer->color_buffer[i] = malloc(content_width + 1);
-                    g_renderer->color_buffer[i][content_width] = '\0';
-                }
-            }
-            
-            pthread_mutex_unlock(&g_renderer->render_lock);
-            
-            // Clear screen and re-render only if we have valid buffers
-            printf(CLEAR_SCREEN);
-            if (content_width > 0 && content_height > 0) {
-                render_frame(g_renderer);
-            }
+void resize_renderer(Renderer *r) {
+    pthread_mutex_lock(&r->render_lock);
+    
+    // Store old dimensions before getting new ones
+    int old_content_height = r->viewport.height - 4;
+    
+    // Get new terminal size
+    get_terminal_size(&r->viewport.width, &r->viewport.height);
+    
+    // Free old buffers if they exist
+    if (r->screen_buffer) {
+        // Use the stored old content height, ensuring we don't go below 0
+        for (int i = 0; i < old_content_height; i++) {
+            free(r->screen_buffer[i]);
+            free(r->color_buffer[i]);
         }
-        return;
+        free(r->screen_buffer);
+        free(r->color_buffer);
+        r->screen_buffer = NULL;
+        r->color_buffer = NULL;
     }
     
-    if (g_renderer) {
+    // Allocate new buffers
+    int content_width = r->viewport.width - 2;
+    int content_height = r->viewport.height - 4;
+    
+    // Ensure we don't allocate negative or zero sized buffers
+    if (content_width > 0 && content_height > 0) {
+        r->screen_buffer = malloc(content_height * sizeof(char*));
+        r->color_buffer = malloc(content_height * sizeof(char*));
+        
+        for (int i = 0; i < content_height; i++) {
+            r->screen_buffer[i] = calloc(content_width * 8 + 1, sizeof(char));
+            r->color_buffer[i] = malloc(content_width + 1);
+            r->color_buffer[i][content_width] = '\0';
+        }
+    }
+    
+    pthread_mutex_unlock(&r->render_lock);
+}
+
+// Async-signal-safe: only writes a byte to the self-pipe. The pipe is
+// non-blocking, so a full pipe (already pending wakeup) is simply ignored.
+void wake_renderer(Renderer *r) {
+    char b = 0;
+    ssize_t ignored = write(r->wake_pipe[1], &b, 1);
+    (void)ignored;
+}
+
+void signal_handler(int sig) {
+    if (!g_renderer) {
+        cleanup_terminal();
+        _exit(0);
+    }
+    
+    // Defer all work to the event loop; nothing here may allocate or print
+    if (sig == SIGWINCH) {
+        g_renderer->resize_pending = 1;
+    } else {
         g_renderer->should_exit = 1;
     }
-    cleanup_terminal();
-    exit(0);
+    wake_renderer(g_renderer);
 }
 
 void setup_terminal(void) {
@@ -279,84 +328,204 @@ void setup_terminal(void) {
     
     raw = orig_termios;
     raw.c_lflag &= ~(ECHO | ICANON);
+    // Reads never block; the event loop polls for readiness instead
     raw.c_cc[VMIN] = 0;
-    raw.c_cc[VTIME] = 1;
+    raw.c_cc[VTIME] = 0;
     
     tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
     printf(HIDE_CURSOR);
     printf(CLEAR_SCREEN);
 }
 
+// Apply a single keypress to the viewport. Caller must hold render_lock.
+// Returns 1 if the key requested exit.
+int handle_key(Renderer *r, char c) {
+    int pan_speed = (int)fmax(1, r->viewport.zoom);
+    
+    switch (c) {
+        case 'w': case 'k': // Up
+            r->viewport.y += pan_speed;
+            break;
+        case 's': case 'j': // Down
+            r->viewport.y -= pan_speed;
+            break;
+        case 'a': case 'h': // Left
+            r->viewport.x -= pan_speed;
+            break;
+        case 'd': case 'l': // Right
+            r->viewport.x += pan_speed;
+            break;
+        case '=': case '+': // Zoom in
+            r->viewport.zoom *= 0.8f;
+            if (r->viewport.zoom < TILE_MIN_ZOOM) r->viewport.zoom = TILE_MIN_ZOOM;
+            break;
+        case '-': case '_': // Zoom out
+            r->viewport.zoom *= 1.25f;
+            if (r->viewport.zoom > TILE_MAX_ZOOM) r->viewport.zoom = TILE_MAX_ZOOM;
+            break;
+        case 'c': // Center view on active coordinates centroid
+            if (r->position_len > 0) {
+                // Centroid of active coordinates, as of the last update
+                int centroid_x = r->centroid.x;
+                int centroid_y = r->centroid.y;
+                
+                // Center viewport on centroid
+                int content_width = r->viewport.width - 2;
+                int content_height = r->viewport.height - 4;
+                
+                // To center the centroid in the visible area:
+                // centroid_x = viewport.x + content_width/2
+                // centroid_y = viewport.y + content_height/2 - 1  (due to coordinate mapping)
+                r->viewport.x = centroid_x - (content_width / 2);
+                r->viewport.y = centroid_y - (content_height / 2) + 1;
+                
+            } else {
+                // Fallback to board center if no active coordinates
+                int content_width = r->viewport.width - 2;
+                int content_height = r->viewport.height - 4;
+                r->viewport.x = r->board_width / 2 - (content_width / 2);
+                r->viewport.y = r->board_height / 2 - (content_height / 2) + 1;
+            }
+            break;
+        case 'm': // Toggle Braille rendering
+            r->braille = !r->braille;
+            break;
+        case 'f': // Cycle between the board and each field layer
+            if (r->current_state) {
+                r->layer = (r->layer + 1) % (r->current_state->field_len + 1);
+            }
+            break;
+        case 'p': // Pause/resume the simulation
+            if (r->governor) set_paused(r->governor, !is_paused(r->governor));
+            break;
+        case 'n': // Single step
+            if (r->governor) {
+                set_paused(r->governor, 1);
+                request_steps(r->governor, 1);
+            }
+            break;
+        case 'b': // Step back one iteration
+        case 'B': // Scrub back 100 iterations
+            if (r->governor) {
+                set_paused(r->governor, 1);
+                request_rewind(r->governor, c == 'B' ? 100 : 1);
+            }
+            break;
+        case '>': case '.': // 10x faster
+            if (r->governor) change_speed(r->governor, 10);
+            break;
+        case '<': case ',': // 10x slower
+            if (r->governor) change_speed(r->governor, 0.1);
+            break;
+        case 'u': // Toggle unbounded speed
+            if (r->governor) {
+                if (get_target_rate(r->governor) > 0) set_target_rate(r->governor, 0);
+                else change_speed(r->governor, 1);
+            }
+            break;
+        case 'q': // Quit
+            r->should_exit = 1;
+            return 1;
+    }
+    return 0;
+}
+
+// Escape sequence parser state for input_thread
+enum { KEY_PLAIN, KEY_ESC, KEY_CSI, KEY_SS3 };
+
+// Returns 1 if c belongs to a terminal escape sequence (arrow keys, function
+// keys, ...) and must not be treated as a keypress. Sequences may be split
+// across reads, so the state persists between calls.
+static int skip_escape(int *state, char c) {
+    switch (*state) {
+        case KEY_ESC:
+            if (c == '[' || c == 'O') {
+                *state = c == '[' ? KEY_CSI : KEY_SS3;
+                return 1;
+            }
+            // A bare ESC keypress: hand the next key over as usual
+            *state = KEY_PLAIN;
+            break;
+        case KEY_CSI:
+            if (c >= 0x40 && c <= 0x7e) *state = KEY_PLAIN;  // Final byte
+            return 1;
+        case KEY_SS3:
+            *state = KEY_PLAIN;
+            return 1;
+    }
+    if (c == '\033') {
+        *state = KEY_ESC;
+        return 1;
+    }
+    return 0;
+}
+
+// Event loop: waits on stdin and the self-pipe, applies every queued
+// keystroke, then redraws at most once per FRAME_INTERVAL.
 void *input_thread(void *arg) {
     Renderer *r = (Renderer *)arg;
-    char c;
+    struct pollfd fds[2] = {
+        { .fd = STDIN_FILENO, .events = POLLIN },
+        { .fd = r->wake_pipe[0], .events = POLLIN },
+    };
+    char buf[256];
+    int escape = KEY_PLAIN;
+    int dirty = 1;
+    double next_frame = 0;
     
     while (!r->should_exit) {
-        if (read(STDIN_FILENO, &c, 1) == 1) {
-            pthread_mutex_lock(&r->render_lock);
-            
-            int pan_speed = (int)fmax(1, r->viewport.zoom);
-            
-            switch (c) {
-                case 'w': case 'k': // Up
-                    r->viewport.y += pan_speed;
-                    break;
-                case 's': case 'j': // Down
-                    r->viewport.y -= pan_speed;
-                    break;
-                case 'a': case 'h': // Left
-                    r->viewport.x -= pan_speed;
-                    break;
-                case 'd': case 'l': // Right
-                    r->viewport.x += pan_speed;
-                    break;
-                case '=': case '+': // Zoom in
-                    r->viewport.zoom *= 0.8f;
-                    if (r->viewport.zoom < 0.5f) r->viewport.zoom = 0.5f;
-                    break;
-                case '-': case '_': // Zoom out
-                    r->viewport.zoom *= 1.25f;
-                    if (r->viewport.zoom > 50.0f) r->viewport.zoom = 50.0f;
-                    break;
-                case 'c': // Center view on active coordinates centroid
-                    if (r->current_state && r->current_state->positions && r->current_state->position_len > 0) {
-                        // Calculate centroid of active coordinates
-                        int sum_x = 0, sum_y = 0;
-                        for (int i = 0; i < r->current_state->position_len; i++) {
-                            sum_x += r->current_state->positions[i].coordinate.x;
-                            sum_y += r->current_state->positions[i].coordinate.y;
-                        }
-                        int centroid_x = sum_x / r->current_state->position_len;
-                        int centroid_y = sum_y / r->current_state->position_len;
-                        
-                        // Center viewport on centroid
-                        int content_width = r->viewport.width - 2;
-                        int content_height = r->viewport.height - 4;
-                        
-                        // To center the centroid in the visible area:
-                        // centroid_x = viewport.x + content_width/2
-                        // centroid_y = viewport.y + content_height/2 - 1  (due to coordinate mapping)
-                        r->viewport.x = centroid_x - (content_width / 2);
-                        r->viewport.y = centroid_y - (content_height / 2) + 1;
-                        
-                    } else {
-                        // Fallback to board center if no active coordinates
-                        int content_width = r->viewport.width - 2;
-                        int content_height = r->viewport.height - 4;
-                        r->viewport.x = r->board_width / 2 - (content_width / 2);
-                        r->viewport.y = r->board_height / 2 - (content_height / 2) + 1;
-                    }
-                    break;
-                case 'q': // Quit
-                    r->should_exit = 1;
-                    pthread_mutex_unlock(&r->render_lock);
-                    return NULL;
+        // Sleep until input arrives, or until the next frame is due if a
+        // redraw is pending
+        int timeout = -1;
+        if (dirty) {
+            double wait = next_frame - now_seconds();
+            timeout = wait > 0 ? (int)ceil(wait * 1000) : 0;
+        }
+        
+        if (poll(fds, 2, timeout) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        
+        if (fds[0].revents & (POLLIN | POLLHUP)) {
+            ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+            if (n > 0) {
+                // Coalesce everything queued into a single viewport update
+                pthread_mutex_lock(&r->render_lock);
+                for (ssize_t i = 0; i < n; i++) {
+                    if (skip_escape(&escape, buf[i])) continue;
+                    if (handle_key(r, buf[i])) break;
+                }
+                pthread_mutex_unlock(&r->render_lock);
+                dirty = 1;
+            } else if (n == 0 && (fds[0].revents & POLLHUP)) {
+                fds[0].fd = -1; // stdin closed, stop polling it
             }
-            
-            pthread_mutex_unlock(&r->render_lock);
-            render_frame(r);
         }
-        usleep(10000); // 10ms
+        
+        if (fds[1].revents & POLLIN) {
+            while (read(r->wake_pipe[0], buf, sizeof(buf)) > 0);
+        }
+        
+        if (r->resize_pending) {
+            r->resize_pending = 0;
+            resize_renderer(r);
+            printf(CLEAR_SCREEN);
+            dirty = 1;
+        }
+        
+        if (__atomic_exchange_n(&r->state_dirty, 0, __ATOMIC_ACQ_REL)) {
+            dirty = 1;
+        }
+        
+        double now = now_seconds();
+        if (dirty && now >= next_frame && !r->should_exit) {
+            if (r->screen_buffer) {
+                render_frame(r);
+            }
+            next_frame = now + FRAME_INTERVAL;
+            dirty = 0;
+        }
     }
     
     return NULL;
@@ -366,10 +535,28 @@ Renderer* create_renderer(int board_width, int board_height) {
     Renderer *r = malloc(sizeof(Renderer));
     if (!r) return NULL;
     
+    if (pipe(r->wake_pipe)) {
+        free(r);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(r->wake_pipe[i], F_SETFL, fcntl(r->wake_pipe[i], F_GETFL) | O_NONBLOCK);
+    }
+    
     r->board_width = board_width;
     r->board_height = board_height;
     r->current_state = NULL;
+    r->iteration = 0;
+    r->position_len = 0;
     r->should_exit = 0;
+    r->resize_pending = 0;
+    r->state_dirty = 0;
+    r->tile = (Tile){0};
+    r->remote = 0;
+    r->governor = NULL;
+    r->layer = 0;
+    r->braille = 0;
+    init_braille_chars();
     
     get_terminal_size(&r->viewport.width, &r->viewport.height);
     r->viewport.x = 0;
@@ -403,19 +590,9 @@ void start_renderer(Renderer *r) {
     g_renderer = r;
     setup_terminal();
     
-    pthread_t input_tid;
-    pthread_create(&input_tid, NULL, input_thread, r);
-    
-    // Initial render
-    render_frame(r);
-    
-    // Main rendering loop
-    while (!r->should_exit) {
-        usleep(16666); // ~60 FPS
-        // Render again if needed (for animations, etc.)
-    }
-    
-    pthread_join(input_tid, NULL);
+    // Input, resizes and new states are all handled by the event loop,
+    // which also performs every redraw
+    input_thread(r);
 }
 
 void* start_render_thread(void *arg) {
@@ -424,16 +601,25 @@ void* start_render_thread(void *arg) {
     return NULL;
 }
 
+// Publish a state to the renderer. Must be called by the thread that
+// advances the state, between steps: the renderer draws from the snapshot
+// taken here and never reads the live state.
 void update_state(Renderer *r, State *new_state) {
     if (!r) return;
     
     pthread_mutex_lock(&r->state_lock);
+    pthread_mutex_lock(&r->render_lock);
     
     r->current_state = new_state;
+    snapshot_state(r, new_state);
     
+    pthread_mutex_unlock(&r->render_lock);
     pthread_mutex_unlock(&r->state_lock);
     
-    render_frame(r);
+    // Only the first update since the last frame needs to wake the loop
+    if (!__atomic_exchange_n(&r->state_dirty, 1, __ATOMIC_ACQ_REL)) {
+        wake_renderer(r);
+    }
 }
 
 void destroy_renderer(Renderer *r) {
@@ -464,6 +650,10 @@ void destroy_renderer(Renderer *r) {
         free(r->color_buffer);
     }
     
+    free_tile(&r->tile);
+    close(r->wake_pipe[0]);
+    close(r->wake_pipe[1]);
+    
     free(r);
     
     cleanup_terminal();
@@ -473,12 +663,18 @@ void destroy_renderer(Renderer *r) {
 State* create_test_state(int width, int height) {
     State *state = malloc(sizeof(State));
     state->board = malloc(height * sizeof(int*));
+    state->size = (Coordinate){width, height};
+    state->population = 0;
+    state->bits_stride = (width + 7) / 8 + 1;
+    state->bits = calloc((size_t)state->bits_stride * height, 1);
     
     for (int y = 0; y < height; y++) {
         state->board[y] = malloc(width * sizeof(int));
         for (int x = 0; x < width; x++) {
             // Create a simple pattern for testing
             state->board[y][x] = ((x + y) % 3 == 0) ? 1 : 0;
+            state->population += state->board[y][x];
+            state->bits[y * state->bits_stride + x / 8] |= state->board[y][x] << (x % 8);
         }
     }
     
@@ -499,8 +695,12 @@ State* create_test_state(int width, int height) {
     state->positions[2].direction = LEFT;
     
     state->iteration = 0;
+    state->seed = 0;
     state->rule_len = 0;
     state->rules = NULL;
+    state->field_len = 0;
+    state->fields = NULL;
+    state->scheduler = NULL;
     
     return state;
 }
@@ -510,6 +710,7 @@ void free_test_state(State *state, int height) {
         free(state->board[y]);
     }
     free(state->board);
+    free(state->bits);
     if (state->positions) {
         free(state->positions);
     }
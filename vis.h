@@ -2,7 +2,10 @@
 #define VIS_H
 
 #include <pthread.h>
+#include <signal.h>
 #include "sim.h"
+#include "tile.h"
+#include "governor.h"
 
 // ANSI escape codes
 #define RESET_COLOR "\033[0m"
@@ -13,6 +16,9 @@
 #define SHOW_CURSOR "\033[?25h"
 #define MOVE_CURSOR(y,x) printf("\033[%d;%dH", (y), (x))
 
+// Minimum time between two redraws (~60 FPS)
+#define FRAME_INTERVAL (1.0 / 60.0)
+
 // Unicode box drawing characters
 #define BOX_HORIZONTAL "─"
 #define BOX_VERTICAL "│"
@@ -24,6 +30,9 @@
 // UTF-8 Unicode block characters for different fill levels
 extern const char *block_chars[];
 
+// UTF-8 Braille patterns, indexed by a tile's Braille glyph index
+extern char braille_chars[256][4];
+
 typedef struct {
     int x, y;           // Bottom-left coordinate
     float zoom;         // Cells per character (1.0 = 1:1, 2.0 = 4 cells per char, etc.)
@@ -39,17 +48,32 @@ typedef struct {
     int should_exit;
     char **screen_buffer;  // Each position stores UTF-8 string
     char **color_buffer;
+    int wake_pipe[2];      // Self-pipe waking the event loop (signals, new states)
+    volatile sig_atomic_t resize_pending;
+    int state_dirty;       // Set by update_state, cleared by the event loop
+    Tile tile;             // Downsampled view of the current frame
+    int iteration;         // Iteration the tile was sampled at
+    Coordinate centroid;   // Mean ant position at that iteration
+    int position_len;
+    int remote;            // Tile is filled by a server rather than sampled locally
+    Governor *governor;    // Speed controls, NULL if the simulation can't be driven
+    int layer;             // 0 shows the board, i shades field i - 1
+    int braille;           // Render 2x4 cells per character as Braille dots
 } Renderer;
 
 // Function declarations
+void init_braille_chars(void);
 void cleanup_terminal(void);
 void get_terminal_size(int *width, int *height);
 int is_active_coordinate(Renderer *r, int x, int y);
 int get_cell_value(Renderer *r, int x, int y);
 void render_character_at_position(Renderer *r, int screen_x, int screen_y, int content_width, int content_height);
 void render_frame(Renderer *r);
+void resize_renderer(Renderer *r);
+void wake_renderer(Renderer *r);
 void signal_handler(int sig);
 void setup_terminal(void);
+int handle_key(Renderer *r, char c);
 void *input_thread(void *arg);
 Renderer* create_renderer(int board_width, int board_height);
 void start_renderer(Renderer *r);
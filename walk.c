@@ -0,0 +1,44 @@
+#include "sim.h"
+#include "rng.h"
+
+// Random walk: each step the ant turns by a random multiple of 90 degrees,
+// moves forward and toggles the cell it lands on. The turn comes from the
+// counter-based RNG, so runs are reproducible and can be rewound.
+
+const Coordinate forward = {0, 1};
+const Coordinate backward = {0, -1};
+
+int walk_condition(State *st, int pos_index) {
+    return 1;
+}
+
+void walk_exec(State *st, int pos_index) {
+    Position *pos = &st->positions[pos_index];
+    int turn = rng_u32(st, pos_index, 0) % 4;
+    pos->direction = (pos->direction + turn) % 4;
+    move(pos, forward);
+    wrap(st, &pos->coordinate);
+
+    int x = pos->coordinate.x, y = pos->coordinate.y;
+    set_cell(st, x, y, !st->board[y][x]);
+}
+
+void walk_inverse(State *st, int pos_index) {
+    Position *pos = &st->positions[pos_index];
+    int x = pos->coordinate.x, y = pos->coordinate.y;
+    set_cell(st, x, y, !st->board[y][x]);
+
+    move(pos, backward);
+    wrap(st, &pos->coordinate);
+    int turn = rng_u32(st, pos_index, 0) % 4;
+    pos->direction = (pos->direction + 4 - turn) % 4;
+}
+
+const Behavior random_walk = { walk_condition, walk_exec, walk_inverse };
+
+int register_random_walk(State *st) {
+    int initial_rules = st->rule_len;
+    add_rules(st, random_walk);
+    if (st->rule_len != initial_rules + 1) return -1;
+    return 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include "sim.h"
+
+int register_random_walk(State *st);
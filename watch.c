@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include "sim.h"
+#include "rng.h"
+#include "watch.h"
+
+// Watchers: a dense block of agents that sit still until a neighbouring
+// cell is filled, then fill their own. Starting from a seed in the middle,
+// the fill spreads through the block as a front; everyone behind or ahead
+// of it is idle, which makes this the example for active-set scheduling.
+//
+// A watcher stamps its cell with the iteration it fired in, so the
+// inverse can tell whether it fired in the iteration being rewound.
+
+static int filled(State *st, int x, int y) {
+    if (x < 0 || y < 0 || x >= st->size.x || y >= st->size.y) return 0;
+    return st->board[y][x] != 0;
+}
+
+int watch_condition(State *st, int pos_index) {
+    int x = st->positions[pos_index].coordinate.x, y = st->positions[pos_index].coordinate.y;
+    if (filled(st, x, y)) return 0;
+    return filled(st, x - 1, y) || filled(st, x + 1, y) ||
+           filled(st, x, y - 1) || filled(st, x, y + 1);
+}
+
+void watch_exec(State *st, int pos_index) {
+    Coordinate c = st->positions[pos_index].coordinate;
+    set_cell(st, c.x, c.y, st->iteration + 1);
+}
+
+void watch_inverse(State *st, int pos_index) {
+    Coordinate c = st->positions[pos_index].coordinate;
+    if (st->board[c.y][c.x] == st->iteration + 1) set_cell(st, c.x, c.y, 0);
+}
+
+// The condition reads the watcher's cell and its four neighbours
+void watch_depends(State *st, int pos_index, Coordinate *lo, Coordinate *hi) {
+    Coordinate c = st->positions[pos_index].coordinate;
+    *lo = (Coordinate){c.x - 1, c.y - 1};
+    *hi = (Coordinate){c.x + 2, c.y + 2};
+}
+
+const Behavior watch = { watch_condition, watch_exec, watch_inverse, watch_depends };
+
+// Replaces the state's positions with a WATCH_SIDE x WATCH_SIDE block of
+// watchers centred on the board, in a seeded random order so the front
+// doesn't race along rows within a single pass, and fills the centre cell
+int register_watchers(State *st) {
+    int n = WATCH_SIDE * WATCH_SIDE;
+    Position *watchers = malloc(n * sizeof(Position));
+    if (!watchers) return -1;
+
+    int x0 = (st->size.x - WATCH_SIDE) / 2, y0 = (st->size.y - WATCH_SIDE) / 2;
+    for (int i = 0; i < n; i++) {
+        watchers[i].coordinate = (Coordinate){x0 + i % WATCH_SIDE, y0 + i / WATCH_SIDE};
+        watchers[i].direction = UP;
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = rng_u32(st, i, 0) % (i + 1);
+        Position t = watchers[i];
+        watchers[i] = watchers[j];
+        watchers[j] = t;
+    }
+
+    st->positions = watchers;
+    st->position_len = n;
+    set_cell(st, st->size.x / 2, st->size.y / 2, -1);
+
+    int initial_rules = st->rule_len;
+    add_rules(st, watch);
+    if (st->rule_len != initial_rules + 1) return -1;
+    return 0;
+}
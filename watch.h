@@ -0,0 +1,6 @@
+#pragma once
+#include "sim.h"
+
+#define WATCH_SIDE 150  // Watchers per side of the block
+
+int register_watchers(State *st);